@@ -0,0 +1,921 @@
+#include "precompiled.hpp"
+#include "ConcurrentQueue.hpp"
+#include "FrameRingAllocator.hpp"
+#include "JobSystem.hpp"
+#include "Task.hpp"
+#include "BackgroundScheduler.hpp"
+#include "EntityWorld.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+
+//Hammers the concurrent containers, job system, coroutine tasks, background scheduler and entity world from several threads and checks nothing was
+//lost, duplicated, reordered or overwritten. Exits non zero on the first failure so ctest picks it up.
+//  ConcurrencyStress [--scale n]   multiplies every item count by n
+namespace
+{
+	uint32_t g_Failures = 0;
+
+	void Check(bool condition, const char* test, const std::string& what)
+	{
+		if (!condition)
+		{
+			++g_Failures;
+			printf("FAIL %s: %s\n", test, what.c_str());
+		}
+	}
+
+	//Items are the producer in the top half and its sequence number in the bottom, so a consumer can tell what went
+	//missing and whether one producer's items came out of order
+	uint64_t MakeItem(uint32_t producer, uint32_t sequence)
+	{
+		return (static_cast<uint64_t>(producer) << 32) | sequence;
+	}
+
+	void StressSPSC(uint32_t itemCount)
+	{
+		//Small on purpose so the ring spends most of the test full or empty
+		SPSCQueue<uint64_t, 64> queue;
+		std::thread producer([&queue, itemCount]()
+		{
+			for (uint32_t i = 0; i < itemCount; ++i)
+			{
+				while (!queue.TryPush(MakeItem(0, i)))
+				{
+					std::this_thread::yield();
+				}
+			}
+		});
+
+		uint32_t expected = 0;
+		bool inOrder = true;
+		while (expected < itemCount)
+		{
+			uint64_t item;
+			if (!queue.TryPop(item))
+			{
+				std::this_thread::yield();
+				continue;
+			}
+			inOrder = inOrder && item == MakeItem(0, expected);
+			++expected;
+		}
+		producer.join();
+
+		Check(inOrder, "spsc", "items came out of order or changed");
+		Check(queue.IsEmpty(), "spsc", "queue not empty after every item was popped");
+		uint64_t extra;
+		Check(!queue.TryPop(extra), "spsc", "popped an item nobody pushed");
+	}
+
+	void StressMPMC(uint32_t producerCount, uint32_t consumerCount, uint32_t itemsPerProducer)
+	{
+		MPMCQueue<uint64_t, 128> queue;
+		std::atomic<uint32_t> consumed(0);
+		const uint32_t total = producerCount * itemsPerProducer;
+
+		//Each consumer's last seen sequence per producer, and how many times each item came out
+		std::vector<std::vector<int64_t>> lastSequence(consumerCount, std::vector<int64_t>(producerCount, -1));
+		std::vector<uint8_t> ordered(consumerCount, 1);
+		std::vector<std::vector<uint8_t>> received(producerCount, std::vector<uint8_t>(itemsPerProducer, 0));
+
+		std::vector<std::thread> threads;
+		for (uint32_t p = 0; p < producerCount; ++p)
+		{
+			threads.emplace_back([&queue, p, itemsPerProducer]()
+			{
+				for (uint32_t i = 0; i < itemsPerProducer; ++i)
+				{
+					while (!queue.TryPush(MakeItem(p, i)))
+					{
+						std::this_thread::yield();
+					}
+				}
+			});
+		}
+		for (uint32_t c = 0; c < consumerCount; ++c)
+		{
+			threads.emplace_back([&, c]()
+			{
+				while (consumed.load(std::memory_order_relaxed) < total)
+				{
+					uint64_t item;
+					if (!queue.TryPop(item))
+					{
+						std::this_thread::yield();
+						continue;
+					}
+					consumed.fetch_add(1, std::memory_order_relaxed);
+					const uint32_t p = static_cast<uint32_t>(item >> 32);
+					const uint32_t sequence = static_cast<uint32_t>(item);
+					if (p >= producerCount || sequence >= itemsPerProducer)
+					{
+						ordered[c] = 0;
+						continue;
+					}
+					//Slots are popped in push order, so one consumer sees any one producer's items in order
+					if (static_cast<int64_t>(sequence) <= lastSequence[c][p])
+					{
+						ordered[c] = 0;
+					}
+					lastSequence[c][p] = sequence;
+					//Distinct items from distinct consumers, so no two threads write the same byte
+					++received[p][sequence];
+				}
+			});
+		}
+		for (auto& thread : threads)
+		{
+			thread.join();
+		}
+
+		uint32_t duplicates = 0;
+		uint32_t missing = 0;
+		for (const auto& producer : received)
+		{
+			for (uint8_t count : producer)
+			{
+				missing += count == 0;
+				duplicates += count > 1;
+			}
+		}
+		for (uint32_t c = 0; c < consumerCount; ++c)
+		{
+			Check(ordered[c] != 0, "mpmc", "consumer " + std::to_string(c) + " saw a producer's items out of order");
+		}
+		Check(missing == 0, "mpmc", std::to_string(missing) + " items never popped");
+		Check(duplicates == 0, "mpmc", std::to_string(duplicates) + " items popped more than once");
+		Check(queue.IsEmpty(), "mpmc", "queue not empty after every item was popped");
+	}
+
+	//Threads allocate blocks and fill them with a tag naming the frame, thread and block. Frames stay in flight for a
+	//while before being released, and every block is checked just before its frame goes, so any overlap with a later
+	//allocation shows up as a broken tag.
+	void StressFrameRing(uint32_t threadCount, uint32_t frameCount, uint32_t blocksPerThread)
+	{
+		FrameRingAllocator allocator(1 << 20);
+		struct Block
+		{
+			uint32_t* mWords;
+			uint32_t mWordCount;
+			uint32_t mTag;
+		};
+		constexpr uint32_t FramesInFlight = 3;
+		std::vector<std::vector<Block>> frames(FramesInFlight);
+		std::vector<std::vector<Block>> threadBlocks(threadCount);
+		uint32_t brokenBlocks = 0;
+
+		auto verify = [&brokenBlocks](const std::vector<Block>& blocks)
+		{
+			for (const Block& block : blocks)
+			{
+				for (uint32_t w = 0; w < block.mWordCount; ++w)
+				{
+					if (block.mWords[w] != block.mTag)
+					{
+						++brokenBlocks;
+						break;
+					}
+				}
+			}
+		};
+
+		std::atomic<uint32_t> nullBlocks(0);
+		for (uint32_t frame = 0; frame < frameCount; ++frame)
+		{
+			std::vector<std::thread> threads;
+			for (uint32_t t = 0; t < threadCount; ++t)
+			{
+				threads.emplace_back([&, t]()
+				{
+					std::mt19937 random(frame * 131 + t);
+					std::vector<Block>& blocks = threadBlocks[t];
+					blocks.clear();
+					for (uint32_t b = 0; b < blocksPerThread; ++b)
+					{
+						const uint32_t wordCount = 1 + (random() % 64);
+						const size_t alignment = size_t(4) << (random() % 5);
+						uint32_t* words = static_cast<uint32_t*>(allocator.Allocate(wordCount * sizeof(uint32_t), alignment));
+						if (words == nullptr || (reinterpret_cast<uintptr_t>(words) & (alignment - 1)) != 0)
+						{
+							nullBlocks.fetch_add(1, std::memory_order_relaxed);
+							continue;
+						}
+						const uint32_t tag = (frame << 20) ^ (t << 12) ^ b ^ 0x5a5a5a5au;
+						for (uint32_t w = 0; w < wordCount; ++w)
+						{
+							words[w] = tag;
+						}
+						blocks.push_back(Block{ words, wordCount, tag });
+					}
+				});
+			}
+			for (auto& thread : threads)
+			{
+				thread.join();
+			}
+
+			std::vector<Block>& current = frames[frame % FramesInFlight];
+			current.clear();
+			for (const auto& blocks : threadBlocks)
+			{
+				current.insert(current.end(), blocks.begin(), blocks.end());
+			}
+			const uint64_t ended = allocator.EndFrame();
+			Check(ended == frame, "frame_ring", "EndFrame returned the wrong frame index");
+
+			//The oldest frame in flight is done with, check nothing was written over it and give its memory back
+			if (frame + 1 >= FramesInFlight)
+			{
+				const uint32_t oldest = frame + 1 - FramesInFlight;
+				verify(frames[oldest % FramesInFlight]);
+				allocator.ReleaseFrame(oldest);
+			}
+		}
+		//A frame's worth is well under a third of the ring, so with three in flight nothing should ever fail
+		Check(nullBlocks.load() == 0, "frame_ring", std::to_string(nullBlocks.load()) + " allocations failed or were misaligned");
+		Check(brokenBlocks == 0, "frame_ring", std::to_string(brokenBlocks) + " blocks overwritten while their frame was in flight");
+	}
+
+	//Filling the ring has to fail cleanly, and releasing has to make the space usable again, wrapped around the end
+	void StressFrameRingExhaustion()
+	{
+		FrameRingAllocator allocator(4096);
+		for (uint32_t round = 0; round < 3; ++round)
+		{
+			uint32_t allocated = 0;
+			while (allocator.Allocate(100, 4) != nullptr)
+			{
+				++allocated;
+			}
+			Check(allocated == 40, "frame_ring_full", "expected 40 blocks of 100 bytes in 4096, got " + std::to_string(allocated));
+			Check(allocator.GetUsed() <= allocator.GetCapacity(), "frame_ring_full", "used more than the capacity");
+
+			allocator.ReleaseFrame(allocator.EndFrame());
+			Check(allocator.GetUsed() == 0, "frame_ring_full", "memory still used after its frame was released");
+		}
+	}
+
+	//Every level hops to a job thread before awaiting its two children, so continuations are resumed from all over
+	Task<uint64_t> SumLeaves(uint32_t depth, uint64_t value)
+	{
+		co_await ResumeOnJobs();
+		if (depth == 0)
+		{
+			co_return value;
+		}
+		const uint64_t left = co_await SumLeaves(depth - 1, value * 2);
+		const uint64_t right = co_await SumLeaves(depth - 1, value * 2 + 1);
+		co_return left + right;
+	}
+
+	Task<uint32_t> Immediate(uint32_t value)
+	{
+		co_return value;
+	}
+
+	//Tasks that finish without ever suspending must not nest the awaiter's stack, or this overflows
+	Task<uint64_t> SumImmediate(uint32_t count)
+	{
+		uint64_t sum = 0;
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			sum += co_await Immediate(i);
+		}
+		co_return sum;
+	}
+
+	Task<void> CountOnJobs(std::atomic<uint32_t>& finished, std::atomic<uint32_t>& wrongThread)
+	{
+		co_await ResumeOnJobs();
+		if (JobSystem::GetThreadIndex() >= JobSystem::Instance()->GetThreadCount())
+		{
+			wrongThread.fetch_add(1, std::memory_order_relaxed);
+		}
+		finished.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	void StressTasks(uint32_t depth, uint32_t immediateCount, uint32_t externalCount)
+	{
+		//Leaves under value 1 at this depth are exactly n to 2n - 1
+		const uint64_t leaves = uint64_t(1) << depth;
+		const uint64_t leafSum = SyncWait(SumLeaves(depth, 1));
+		Check(leafSum == leaves * leaves + leaves * (leaves - 1) / 2, "task", "tree of awaited tasks summed to " + std::to_string(leafSum));
+
+		const uint64_t immediateSum = SyncWait(SumImmediate(immediateCount));
+		Check(immediateSum == uint64_t(immediateCount) * (immediateCount - 1) / 2, "task", "awaiting finished tasks summed to " + std::to_string(immediateSum));
+
+		//Started from a thread that isn't a job thread, so every hop goes through the job system's external queue
+		std::atomic<uint32_t> finished(0);
+		std::atomic<uint32_t> wrongThread(0);
+		JobCounter counter;
+		std::thread outsider([&]()
+		{
+			for (uint32_t i = 0; i < externalCount; ++i)
+			{
+				StartTask(CountOnJobs(finished, wrongThread), &counter);
+			}
+		});
+		outsider.join();
+		JobSystem::Instance()->Wait(counter);
+		Check(finished.load() == externalCount, "task", std::to_string(finished.load()) + " of " + std::to_string(externalCount) + " tasks from outside ran");
+		Check(wrongThread.load() == 0, "task", std::to_string(wrongThread.load()) + " tasks resumed off the job threads");
+
+		const char* path = "concurrency_stress_read.bin";
+		std::vector<char> written(100000);
+		for (size_t i = 0; i < written.size(); ++i)
+		{
+			written[i] = static_cast<char>(i * 7);
+		}
+		{
+			std::ofstream stream(path, std::ios::binary);
+			stream.write(written.data(), written.size());
+		}
+		Check(SyncWait(ReadFileAsync(path)) == written, "task", "file read on a job thread came back different");
+		std::remove(path);
+		Check(SyncWait(ReadFileAsync("concurrency_stress_missing.bin")).empty(), "task", "reading a missing file wasn't empty");
+	}
+
+	//The render thread splits recording with ParallelFor, waiting without running jobs since it isn't a job thread
+	void StressOutsideParallelFor(uint32_t frameCount)
+	{
+		uint32_t brokenFrames = 0;
+		std::atomic<uint32_t> wrongThread(0);
+		std::thread outsider([&]()
+		{
+			for (uint32_t frame = 0; frame < frameCount; ++frame)
+			{
+				std::vector<uint8_t> covered(4096, 0);
+				JobSystem::Instance()->ParallelFor(0, 4096, 16, [&covered, &wrongThread](uint32_t begin, uint32_t end)
+				{
+					if (JobSystem::GetThreadIndex() >= JobSystem::Instance()->GetThreadCount())
+					{
+						wrongThread.fetch_add(1, std::memory_order_relaxed);
+					}
+					for (uint32_t i = begin; i < end; ++i)
+					{
+						++covered[i];
+					}
+				});
+				brokenFrames += std::count(covered.begin(), covered.end(), 1) != 4096;
+
+				//A single piece takes the same trip through the queue rather than running here
+				uint32_t singleCalls = 0;
+				JobSystem::Instance()->ParallelFor(0, 8, 16, [&singleCalls, &wrongThread](uint32_t begin, uint32_t end)
+				{
+					if (JobSystem::GetThreadIndex() >= JobSystem::Instance()->GetThreadCount())
+					{
+						wrongThread.fetch_add(1, std::memory_order_relaxed);
+					}
+					singleCalls += begin == 0 && end == 8;
+				});
+				brokenFrames += singleCalls != 1;
+			}
+		});
+		outsider.join();
+		Check(brokenFrames == 0, "outside_parallel_for", std::to_string(brokenFrames) + " parallel fors from outside missed or repeated part of their range");
+		Check(wrongThread.load() == 0, "outside_parallel_for", std::to_string(wrongThread.load()) + " pieces ran on the thread that isn't a job thread");
+	}
+
+	//The owner pushes and pops the bottom while thieves steal from the top. Every job has to come out exactly once, and a
+	//full deque has to refuse the push rather than overwrite.
+	void StressJobDeque(uint32_t thiefCount, uint32_t jobCount)
+	{
+		JobDeque deque;
+		std::vector<Job> jobs(jobCount);
+		std::vector<std::atomic<uint32_t>> taken(jobCount);
+		for (uint32_t i = 0; i < jobCount; ++i)
+		{
+			jobs[i].mData = reinterpret_cast<void*>(static_cast<uintptr_t>(i));
+			taken[i].store(0, std::memory_order_relaxed);
+		}
+		auto take = [&taken, jobCount](Job* job)
+		{
+			const uintptr_t index = reinterpret_cast<uintptr_t>(job->mData);
+			if (index < jobCount)
+			{
+				taken[index].fetch_add(1, std::memory_order_relaxed);
+			}
+		};
+
+		std::atomic<bool> ownerDone(false);
+		std::vector<std::thread> thieves;
+		for (uint32_t t = 0; t < thiefCount; ++t)
+		{
+			thieves.emplace_back([&deque, &ownerDone, &take]()
+			{
+				//Once the owner has popped it empty nothing else can turn up, one last failed steal means it's over
+				for (;;)
+				{
+					const bool done = ownerDone.load(std::memory_order_acquire);
+					Job* job = deque.Steal();
+					if (job != nullptr)
+					{
+						take(job);
+					}
+					else if (done)
+					{
+						return;
+					}
+					else
+					{
+						std::this_thread::yield();
+					}
+				}
+			});
+		}
+
+		uint32_t refused = 0;
+		for (uint32_t i = 0; i < jobCount; ++i)
+		{
+			if (!deque.Push(&jobs[i]))
+			{
+				++refused;
+				take(&jobs[i]);
+			}
+			//Pop every third push so the bottom moves both ways and often races a thief for the last job
+			if (i % 3 == 2)
+			{
+				if (Job* job = deque.Pop())
+				{
+					take(job);
+				}
+			}
+		}
+		while (Job* job = deque.Pop())
+		{
+			take(job);
+		}
+		ownerDone.store(true, std::memory_order_release);
+		for (auto& thief : thieves)
+		{
+			thief.join();
+		}
+
+		uint32_t missing = 0;
+		uint32_t duplicates = 0;
+		for (const auto& count : taken)
+		{
+			missing += count.load() == 0;
+			duplicates += count.load() > 1;
+		}
+		Check(missing == 0, "job_deque", std::to_string(missing) + " jobs never came out");
+		Check(duplicates == 0, "job_deque", std::to_string(duplicates) + " jobs came out more than once");
+		Check(deque.Pop() == nullptr && deque.Steal() == nullptr, "job_deque", "a job came out of the emptied deque");
+
+		//Alone, the bottom comes back last in first out and the top first in first out, and a full deque says so
+		JobDeque full;
+		uint32_t pushed = 0;
+		while (pushed <= JobDeque::Capacity && full.Push(&jobs[pushed % jobCount]))
+		{
+			++pushed;
+		}
+		Check(pushed == JobDeque::Capacity, "job_deque", "held " + std::to_string(pushed) + " jobs, capacity is " + std::to_string(JobDeque::Capacity));
+		Check(full.Pop() == &jobs[(JobDeque::Capacity - 1) % jobCount], "job_deque", "pop didn't return the newest job");
+		Check(full.Steal() == &jobs[0], "job_deque", "steal didn't return the oldest job");
+	}
+
+	//A job in a chain, it checks every job of the group before it has finished, then counts itself done
+	struct ChainStep
+	{
+		std::atomic<uint32_t>* mBefore; //Null for the first group
+		uint32_t mBeforeCount;
+		std::atomic<uint32_t>* mFinished;
+		std::atomic<uint32_t>* mEarly;
+	};
+
+	void RunChainStep(void* data)
+	{
+		ChainStep& step = *static_cast<ChainStep*>(data);
+		if (step.mBefore != nullptr && step.mBefore->load(std::memory_order_acquire) != step.mBeforeCount)
+		{
+			step.mEarly->fetch_add(1, std::memory_order_relaxed);
+		}
+		step.mFinished->fetch_add(1, std::memory_order_release);
+	}
+
+	//RunAfter jobs may only start once every job of their dependency has finished, whether they were queued before or
+	//after it got there, and a chain of them has to keep that order all the way down
+	void StressRunAfter(uint32_t rounds)
+	{
+		constexpr uint32_t FirstCount = 32;
+		constexpr uint32_t ThenCount = 16;
+		uint32_t brokenRounds = 0;
+		for (uint32_t round = 0; round < rounds; ++round)
+		{
+			std::atomic<uint32_t> firstFinished(0);
+			std::atomic<uint32_t> thenFinished(0);
+			std::atomic<uint32_t> lastFinished(0);
+			std::atomic<uint32_t> early(0);
+			ChainStep first = { nullptr, 0, &firstFinished, &early };
+			ChainStep then = { &firstFinished, FirstCount, &thenFinished, &early };
+			ChainStep last = { &thenFinished, ThenCount, &lastFinished, &early };
+
+			std::vector<Job> jobs(FirstCount + ThenCount + 1);
+			std::vector<Job*> pointers(jobs.size());
+			for (uint32_t i = 0; i < jobs.size(); ++i)
+			{
+				jobs[i].mFunction = RunChainStep;
+				jobs[i].mData = i < FirstCount ? &first : i < FirstCount + ThenCount ? &then : &last;
+				pointers[i] = &jobs[i];
+			}
+
+			JobCounter firstCounter;
+			JobCounter thenCounter;
+			JobCounter lastCounter;
+			//Odd rounds queue the continuations while the first group is held back, even ones race it finishing
+			if (round & 1)
+			{
+				JobSystem::Instance()->Hold(firstCounter);
+			}
+			JobSystem::Instance()->Run(pointers.data(), FirstCount, firstCounter);
+			JobSystem::Instance()->RunAfter(firstCounter, pointers.data() + FirstCount, ThenCount, thenCounter);
+			JobSystem::Instance()->RunAfter(thenCounter, pointers.data() + FirstCount + ThenCount, 1, lastCounter);
+			if (round & 1)
+			{
+				JobSystem::Instance()->Release(firstCounter);
+			}
+			JobSystem::Instance()->Wait(lastCounter);
+
+			brokenRounds += early.load() != 0 || lastFinished.load() != 1 || !firstCounter.IsDone() || !thenCounter.IsDone();
+		}
+		Check(brokenRounds == 0, "run_after", std::to_string(brokenRounds) + " rounds ran a continuation early or lost one");
+	}
+
+	//A job that runs a parallel for of its own waits on it from a job thread, running other jobs meanwhile
+	void StressNestedParallelFor(uint32_t frameCount)
+	{
+		constexpr uint32_t Outer = 64;
+		constexpr uint32_t Inner = 1024;
+		uint32_t brokenFrames = 0;
+		for (uint32_t frame = 0; frame < frameCount; ++frame)
+		{
+			std::vector<std::atomic<uint32_t>> covered(Outer * Inner);
+			for (auto& count : covered)
+			{
+				count.store(0, std::memory_order_relaxed);
+			}
+			JobSystem::Instance()->ParallelFor(0, Outer, 1, [&covered](uint32_t outerBegin, uint32_t outerEnd)
+			{
+				for (uint32_t outer = outerBegin; outer < outerEnd; ++outer)
+				{
+					JobSystem::Instance()->ParallelFor(0, Inner, 32, [&covered, outer](uint32_t begin, uint32_t end)
+					{
+						for (uint32_t i = begin; i < end; ++i)
+						{
+							covered[outer * Inner + i].fetch_add(1, std::memory_order_relaxed);
+						}
+					});
+				}
+			});
+			brokenFrames += std::any_of(covered.begin(), covered.end(), [](const std::atomic<uint32_t>& count) { return count.load() != 1; });
+		}
+		Check(brokenFrames == 0, "nested_parallel_for", std::to_string(brokenFrames) + " nested parallel fors missed or repeated part of their range");
+	}
+
+	struct SplitData
+	{
+		uint32_t mDepth;
+		std::atomic<uint32_t>* mLeaves;
+	};
+
+	//Each job splits in two, runs both halves against a counter on its own stack and waits for them before returning, so
+	//the counter is gone the moment Wait does. The last job to finish must be done with it by then.
+	void SplitJob(void* data)
+	{
+		SplitData& split = *static_cast<SplitData*>(data);
+		if (split.mDepth == 0)
+		{
+			split.mLeaves->fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+		SplitData halves[2] = { { split.mDepth - 1, split.mLeaves }, { split.mDepth - 1, split.mLeaves } };
+		Job jobs[2];
+		Job* pointers[2] = { &jobs[0], &jobs[1] };
+		for (uint32_t i = 0; i < 2; ++i)
+		{
+			jobs[i].mFunction = SplitJob;
+			jobs[i].mData = &halves[i];
+		}
+		JobCounter counter;
+		JobSystem::Instance()->Run(pointers, 2, counter);
+		JobSystem::Instance()->Wait(counter);
+	}
+
+	void StressStackCounters(uint32_t depth, uint32_t rounds)
+	{
+		uint32_t brokenRounds = 0;
+		for (uint32_t round = 0; round < rounds; ++round)
+		{
+			std::atomic<uint32_t> leaves(0);
+			SplitData root = { depth, &leaves };
+			SplitJob(&root);
+			brokenRounds += leaves.load() != (1u << depth);
+		}
+		Check(brokenRounds == 0, "stack_counters", std::to_string(brokenRounds) + " rounds lost leaves of the split");
+	}
+
+	//Counts live copies so a component the world forgets to destroy, or destroys twice, shows up. The value sits behind
+	//a pointer so one moved without its move constructor, or read after being moved from, crashes or reads null.
+	struct TrackedComponent
+	{
+		static std::atomic<int32_t> s_Live;
+		std::unique_ptr<uint32_t> mValue;
+
+		explicit TrackedComponent(uint32_t value) : mValue(new uint32_t(value)) { s_Live.fetch_add(1, std::memory_order_relaxed); }
+		TrackedComponent(TrackedComponent&& b) noexcept : mValue(std::move(b.mValue)) { s_Live.fetch_add(1, std::memory_order_relaxed); }
+		~TrackedComponent() { s_Live.fetch_sub(1, std::memory_order_relaxed); }
+	};
+	std::atomic<int32_t> TrackedComponent::s_Live(0);
+
+	struct TagComponent
+	{
+		uint32_t mValue;
+	};
+
+	struct ExtraComponent
+	{
+		uint64_t mValue[3];
+	};
+
+	//Entities hop between archetypes and get destroyed at random while a plain copy of what each one should hold is kept
+	//alongside. Every move fills a hole with another archetype's last row, so all of them are checked after each round.
+	void StressEntityWorld(uint32_t entityCount, uint32_t rounds)
+	{
+		EntityWorld::CreateInstance();
+		EntityWorld& world = *EntityWorld::Instance();
+
+		struct Expected
+		{
+			Entity mEntity;
+			uint32_t mValue;
+			bool mAlive;
+			bool mTracked;
+			bool mExtra;
+		};
+		std::vector<Expected> expected;
+		std::mt19937 random(12345);
+		uint32_t nextValue = 0;
+		auto create = [&]()
+		{
+			const uint32_t value = nextValue++;
+			const Entity entity = world.CreateEntity(TagComponent{ value }, TrackedComponent(value));
+			expected.push_back(Expected{ entity, value, true, true, false });
+		};
+		for (uint32_t i = 0; i < entityCount; ++i)
+		{
+			create();
+		}
+
+		uint32_t wrongEntities = 0;
+		uint32_t reusedIndices = 0;
+		uint32_t staleAlive = 0;
+		for (uint32_t round = 0; round < rounds; ++round)
+		{
+			std::vector<Entity> destroyed;
+			for (Expected& entry : expected)
+			{
+				if (!entry.mAlive)
+				{
+					continue;
+				}
+				switch (random() % 8)
+				{
+				case 0:
+					world.DestroyEntity(entry.mEntity);
+					destroyed.push_back(entry.mEntity);
+					entry.mAlive = false;
+					break;
+				case 1:
+				case 2:
+					if (entry.mExtra)
+					{
+						world.RemoveComponent<ExtraComponent>(entry.mEntity);
+					}
+					else
+					{
+						world.AddComponent(entry.mEntity, ExtraComponent{ { entry.mValue, entry.mValue * 2ull, entry.mValue * 3ull } });
+					}
+					entry.mExtra = !entry.mExtra;
+					break;
+				case 3:
+					if (entry.mTracked)
+					{
+						world.RemoveComponent<TrackedComponent>(entry.mEntity);
+					}
+					else
+					{
+						world.AddComponent(entry.mEntity, TrackedComponent(entry.mValue));
+					}
+					entry.mTracked = !entry.mTracked;
+					break;
+				default:
+					break;
+				}
+			}
+
+			//Freed records are handed out again under a new generation, the old handles have to stay dead
+			const size_t firstNew = expected.size();
+			for (size_t i = 0; i < destroyed.size(); ++i)
+			{
+				create();
+			}
+			for (size_t i = firstNew; i < expected.size(); ++i)
+			{
+				for (const Entity& old : destroyed)
+				{
+					reusedIndices += old.mIndex == expected[i].mEntity.mIndex && old.mGeneration != expected[i].mEntity.mGeneration;
+				}
+			}
+			for (const Entity& old : destroyed)
+			{
+				staleAlive += world.IsAlive(old);
+			}
+
+			int32_t tracked = 0;
+			size_t alive = 0;
+			for (const Expected& entry : expected)
+			{
+				if (!entry.mAlive)
+				{
+					continue;
+				}
+				++alive;
+				tracked += entry.mTracked;
+				const TagComponent* tag = world.Get<TagComponent>(entry.mEntity);
+				const TrackedComponent* trackedComponent = world.Get<TrackedComponent>(entry.mEntity);
+				const ExtraComponent* extra = world.Get<ExtraComponent>(entry.mEntity);
+				bool right = world.IsAlive(entry.mEntity) && tag != nullptr && tag->mValue == entry.mValue;
+				right = right && (trackedComponent != nullptr) == entry.mTracked && (extra != nullptr) == entry.mExtra;
+				right = right && (trackedComponent == nullptr || (trackedComponent->mValue != nullptr && *trackedComponent->mValue == entry.mValue));
+				right = right && (extra == nullptr || (extra->mValue[0] == entry.mValue && extra->mValue[2] == entry.mValue * 3ull));
+				wrongEntities += !right;
+			}
+			Check(world.GetEntityCount() == alive, "entity_world", "world holds " + std::to_string(world.GetEntityCount()) + " entities, expected " + std::to_string(alive));
+			Check(TrackedComponent::s_Live.load() == tracked, "entity_world", std::to_string(TrackedComponent::s_Live.load()) + " tracked components alive, expected " + std::to_string(tracked));
+
+			//Every chunk once, each row naming the entity it belongs to, whichever thread gets it
+			std::atomic<uint32_t> visited(0);
+			std::atomic<uint32_t> misplaced(0);
+			world.ParallelForEachChunk<TagComponent>([&world, &visited, &misplaced](uint32_t count, const Entity* entities, const TagComponent* tags)
+			{
+				for (uint32_t i = 0; i < count; ++i)
+				{
+					if (world.Get<TagComponent>(entities[i]) != &tags[i])
+					{
+						misplaced.fetch_add(1, std::memory_order_relaxed);
+					}
+				}
+				visited.fetch_add(count, std::memory_order_relaxed);
+			});
+			Check(visited.load() == alive, "entity_world", "parallel chunks visited " + std::to_string(visited.load()) + " of " + std::to_string(alive) + " entities");
+			Check(misplaced.load() == 0, "entity_world", std::to_string(misplaced.load()) + " rows disagree with their entity's record");
+		}
+		Check(wrongEntities == 0, "entity_world", std::to_string(wrongEntities) + " entity checks found the wrong components");
+		Check(reusedIndices != 0, "entity_world", "no destroyed entity's index was reused");
+		Check(staleAlive == 0, "entity_world", std::to_string(staleAlive) + " destroyed handles still counted as alive");
+
+		//Tearing the world down has to destroy every component still in it
+		EntityWorld::DestroyInstance();
+		Check(TrackedComponent::s_Live.load() == 0, "entity_world", std::to_string(TrackedComponent::s_Live.load()) + " tracked components outlived the world");
+	}
+
+	void SpinFor(std::chrono::microseconds duration)
+	{
+		const auto end = std::chrono::steady_clock::now() + duration;
+		while (std::chrono::steady_clock::now() < end)
+		{
+		}
+	}
+
+	void StressBackground(uint32_t taskCount, uint32_t stepsPerTask)
+	{
+		BackgroundScheduler& scheduler = *BackgroundScheduler::Instance();
+
+		//Strict priority, and game thread tasks only ever run in a frame slice
+		std::vector<int> order;
+		scheduler.Submit([&order]() { order.push_back(2); return false; }, BackgroundPriority::Low, false);
+		scheduler.Submit([&order]() { order.push_back(1); return false; }, BackgroundPriority::Normal, false);
+		scheduler.Submit([&order]() { order.push_back(0); return false; }, BackgroundPriority::High, false);
+		scheduler.RunFrameSlice();
+		Check(order == std::vector<int>({ 0, 1, 2 }), "background", "priorities ran out of order");
+
+		//Every step takes at least 500us, so a 2ms budget can't fit more than four plus the one that always runs
+		scheduler.SetFrameBudget(std::chrono::microseconds(2000));
+		uint32_t gameSteps = 0;
+		for (uint32_t t = 0; t < taskCount; ++t)
+		{
+			scheduler.Submit([&gameSteps, left = stepsPerTask]() mutable
+			{
+				SpinFor(std::chrono::microseconds(500));
+				++gameSteps;
+				return --left != 0;
+			}, BackgroundPriority::Normal, false);
+		}
+		uint32_t slices = 0;
+		uint32_t mostSteps = 0;
+		while (gameSteps < taskCount * stepsPerTask && slices < 100000)
+		{
+			mostSteps = (std::max)(mostSteps, scheduler.RunFrameSlice());
+			++slices;
+		}
+		Check(gameSteps == taskCount * stepsPerTask, "background", "game thread tasks never finished");
+		Check(mostSteps <= 5, "background", "a 2ms slice ran " + std::to_string(mostSteps) + " steps of 500us");
+
+		//With no frame slices at all, the idle worker has to get through the any thread tasks by itself
+		std::atomic<uint32_t> workerSteps(0);
+		std::atomic<uint32_t> gameThreadSteps(0);
+		for (uint32_t t = 0; t < taskCount; ++t)
+		{
+			scheduler.Submit([&workerSteps, &gameThreadSteps, left = stepsPerTask]() mutable
+			{
+				if (JobSystem::GetThreadIndex() == 0)
+				{
+					gameThreadSteps.fetch_add(1, std::memory_order_relaxed);
+				}
+				workerSteps.fetch_add(1, std::memory_order_relaxed);
+				return --left != 0;
+			}, BackgroundPriority::Low, true);
+		}
+		const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+		while (workerSteps.load() < taskCount * stepsPerTask && std::chrono::steady_clock::now() < deadline)
+		{
+			std::this_thread::yield();
+		}
+		Check(workerSteps.load() == taskCount * stepsPerTask, "background", std::to_string(workerSteps.load()) + " worker steps of " + std::to_string(taskCount * stepsPerTask));
+		Check(gameThreadSteps.load() == 0, "background", "worker steps ran on the game thread outside a frame slice");
+
+		//Frame jobs and background steps mixed, every parallel for still has to cover its whole range
+		std::atomic<uint32_t> mixedSteps(0);
+		for (uint32_t t = 0; t < taskCount; ++t)
+		{
+			scheduler.Submit([&mixedSteps, left = stepsPerTask * 10]() mutable
+			{
+				mixedSteps.fetch_add(1, std::memory_order_relaxed);
+				return --left != 0;
+			}, BackgroundPriority::Low, true);
+		}
+		uint32_t brokenFrames = 0;
+		for (uint32_t frame = 0; frame < 200 || mixedSteps.load() < taskCount * stepsPerTask * 10; ++frame)
+		{
+			std::atomic<uint32_t> covered(0);
+			JobSystem::Instance()->ParallelFor(0, 4096, 64, [&covered](uint32_t begin, uint32_t end) { covered.fetch_add(end - begin, std::memory_order_relaxed); });
+			brokenFrames += covered.load() != 4096;
+			scheduler.RunFrameSlice();
+		}
+		Check(brokenFrames == 0, "background", std::to_string(brokenFrames) + " parallel fors missed part of their range");
+	}
+}
+
+int main(int argc, char** argv)
+{
+	uint32_t scale = 1;
+	for (int i = 1; i < argc; ++i)
+	{
+		const std::string arg = argv[i];
+		if (arg == "--scale" && i + 1 < argc)
+		{
+			scale = static_cast<uint32_t>(std::stoul(argv[++i]));
+		}
+		else
+		{
+			printf("ConcurrencyStress [--scale n]\n");
+			return 1;
+		}
+	}
+
+	StressSPSC(1000000 * scale);
+	StressMPMC(4, 4, 100000 * scale);
+	StressMPMC(1, 6, 200000 * scale);
+	StressMPMC(6, 1, 50000 * scale);
+	StressFrameRing(4, 200 * scale, 250);
+	StressFrameRingExhaustion();
+
+	//More threads than this machine may have cores, so the hops really do cross threads
+	JobSystem::CreateInstance(7);
+	StressTasks(14, 1000000 * scale, 20000 * scale);
+	StressOutsideParallelFor(500 * scale);
+	StressJobDeque(3, 200000 * scale);
+	StressRunAfter(2000 * scale);
+	StressNestedParallelFor(100 * scale);
+	StressStackCounters(12, 20 * scale);
+	StressEntityWorld(5000 * scale, 20);
+	BackgroundScheduler::CreateInstance();
+	StressBackground(8, 20 * scale);
+	BackgroundScheduler::DestroyInstance();
+	JobSystem::DestroyInstance();
+
+	if (g_Failures != 0)
+	{
+		printf("%u failures\n", g_Failures);
+		return 1;
+	}
+	printf("all passed\n");
+	return 0;
+}
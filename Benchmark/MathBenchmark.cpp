@@ -0,0 +1,765 @@
+#include "precompiled.hpp"
+#include "MathSIMD.hpp"
+#include "Vector3.hpp"
+#include "Vector4.hpp"
+#include "Matrix4.hpp"
+#include "AffineTransform.hpp"
+#include "Quaternion.hpp"
+#include "TransformBatch.hpp"
+#include "FastMath.hpp"
+#include "Frustum.hpp"
+#include "Camera.hpp"
+#include "Half.hpp"
+#include "TransformStore.hpp"
+#include "EntityWorld.hpp"
+#include "JobSystem.hpp"
+#include "MathConstants.hpp"
+#include "ConcurrentQueue.hpp"
+#include "FrameRingAllocator.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <deque>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <thread>
+
+namespace
+{
+	struct Result
+	{
+		std::string mName;
+		size_t mCount;
+		double mNsPerOp;
+		double mOpsPerSecond;
+		uint64_t mOperations;
+	};
+
+	struct Options
+	{
+		std::string mJsonPath = "math_benchmark.json";
+		std::string mBaselinePath;
+		size_t mMaxCount = 1000000;
+		double mMinTrialSeconds = 0.01;
+		uint32_t mTrials = 5;
+	};
+
+	typedef std::chrono::steady_clock Clock;
+
+	//Every kernel folds one output into this so the optimiser cannot drop the work
+	volatile float g_Sink = 0.0f;
+
+	const char* SimdPath()
+	{
+#if defined(MATH_SIMD_AVX2)
+		return "avx2";
+#elif defined(MATH_SIMD_SSE2)
+		return "sse2";
+#else
+		return "scalar";
+#endif
+	}
+
+	//Runs kernel(count) until a trial lasts at least mMinTrialSeconds, then keeps the fastest of mTrials trials
+	template<typename Kernel>
+	Result Measure(const Options& options, const char* name, size_t count, Kernel&& kernel)
+	{
+		kernel(count);
+
+		uint64_t repetitions = 1;
+		for (;;)
+		{
+			const auto start = Clock::now();
+			for (uint64_t i = 0; i < repetitions; ++i)
+			{
+				kernel(count);
+			}
+			const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+			if (seconds >= options.mMinTrialSeconds)
+			{
+				break;
+			}
+			repetitions *= 2;
+		}
+
+		double best = 1e300;
+		for (uint32_t trial = 0; trial < options.mTrials; ++trial)
+		{
+			const auto start = Clock::now();
+			for (uint64_t i = 0; i < repetitions; ++i)
+			{
+				kernel(count);
+			}
+			best = (std::min)(best, std::chrono::duration<double>(Clock::now() - start).count());
+		}
+
+		const double operations = static_cast<double>(repetitions) * static_cast<double>(count);
+		return Result{ name, count, (best * 1e9) / operations, operations / best, repetitions * count };
+	}
+
+	//Stand ins for a render object's hot motion data and its cold mesh data
+	struct BenchmarkMotion
+	{
+		Vector3 mPosition;
+		Vector3 mVelocity;
+	};
+
+	struct BenchmarkMesh
+	{
+		float mPayload[60];
+	};
+
+	struct BenchmarkObject
+	{
+		BenchmarkMotion mMotion;
+		BenchmarkMesh mMesh;
+	};
+
+	//Stand in for RenderSpin, the per object angles the render object update advances
+	struct BenchmarkSpin
+	{
+		float mAngleX;
+		float mAngleY;
+		float mDegreesPerSecond = 60.0f;
+	};
+
+	struct BenchmarkRotationWrites
+	{
+		std::vector<TransformHandle> mTransforms;
+		std::vector<Quaternion> mRotations;
+	};
+
+	//One 60Hz simulation step
+	void AdvanceSpin(BenchmarkSpin& spin)
+	{
+		const float degrees = spin.mDegreesPerSecond * (1.0f / 60.0f);
+		spin.mAngleX = fmod(spin.mAngleX + degrees, 360.0f);
+		spin.mAngleY = fmod(spin.mAngleY + degrees, 360.0f);
+	}
+
+	//Pushes count items from producerCount threads and pops them on consumerCount threads, one of which is the caller.
+	//Both ends spin on a full or empty queue, so this is the cost of the handoff itself.
+	template<typename Queue>
+	uint64_t TransferThroughQueue(Queue& queue, size_t count, uint32_t producerCount, uint32_t consumerCount)
+	{
+		std::atomic<uint64_t> popped(0);
+		std::atomic<uint64_t> sum(0);
+		auto consume = [&queue, &popped, &sum, count]()
+		{
+			uint64_t localSum = 0;
+			uint64_t item;
+			while (popped.load(std::memory_order_relaxed) < count)
+			{
+				if (queue.TryPop(item))
+				{
+					localSum += item;
+					popped.fetch_add(1, std::memory_order_relaxed);
+				}
+				else
+				{
+					std::this_thread::yield();
+				}
+			}
+			sum.fetch_add(localSum, std::memory_order_relaxed);
+		};
+
+		std::vector<std::thread> threads;
+		for (uint32_t p = 0; p < producerCount; ++p)
+		{
+			threads.emplace_back([&queue, p, producerCount, count]()
+			{
+				for (uint64_t i = p; i < count; i += producerCount)
+				{
+					while (!queue.TryPush(i))
+					{
+						std::this_thread::yield();
+					}
+				}
+			});
+		}
+		for (uint32_t c = 1; c < consumerCount; ++c)
+		{
+			threads.emplace_back(consume);
+		}
+		consume();
+		for (auto& thread : threads)
+		{
+			thread.join();
+		}
+		return sum.load();
+	}
+
+	//What the lock free queues replace, a deque behind a mutex
+	struct MutexQueue
+	{
+		std::mutex mMutex;
+		std::deque<uint64_t> mItems;
+
+		bool TryPush(uint64_t item)
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			mItems.push_back(item);
+			return true;
+		}
+		bool TryPop(uint64_t& item)
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			if (mItems.empty())
+			{
+				return false;
+			}
+			item = mItems.front();
+			mItems.pop_front();
+			return true;
+		}
+	};
+
+	std::vector<Matrix4> RandomMatrices(std::mt19937& random, size_t count)
+	{
+		std::uniform_real_distribution<float> value(-1.0f, 1.0f);
+		std::vector<Matrix4> matrices(count);
+		for (auto& matrix : matrices)
+		{
+			//Diagonally dominant so every inverse exists
+			for (uint32_t c = 0; c < 4; ++c)
+			{
+				for (uint32_t r = 0; r < 4; ++r)
+				{
+					matrix.matrix[c][r] = value(random) + (c == r ? 4.0f : 0.0f);
+				}
+			}
+		}
+		return matrices;
+	}
+
+	std::vector<Quaternion> RandomRotations(std::mt19937& random, size_t count)
+	{
+		std::uniform_real_distribution<float> value(-1.0f, 1.0f);
+		std::vector<Quaternion> rotations(count);
+		for (auto& rotation : rotations)
+		{
+			rotation = Quaternion::FromAngleAxis(value(random) * 180.0f, Vector3(value(random), value(random), value(random) + 2.0f));
+		}
+		return rotations;
+	}
+
+	std::vector<float> RandomFloats(std::mt19937& random, size_t count, float low, float high)
+	{
+		std::uniform_real_distribution<float> value(low, high);
+		std::vector<float> values(count);
+		for (auto& v : values)
+		{
+			v = value(random);
+		}
+		return values;
+	}
+
+	std::vector<Vector3> RandomVectors(std::mt19937& random, size_t count)
+	{
+		std::uniform_real_distribution<float> value(-10.0f, 10.0f);
+		std::vector<Vector3> vectors(count);
+		for (auto& vec : vectors)
+		{
+			vec = Vector3(value(random), value(random), value(random) + 20.0f);
+		}
+		return vectors;
+	}
+
+	void RunSize(const Options& options, size_t count, std::vector<Result>& results)
+	{
+		std::mt19937 random(1234u + static_cast<uint32_t>(count));
+
+		{
+			const std::vector<Matrix4> in = RandomMatrices(random, count);
+			const Matrix4 b = RandomMatrices(random, 1)[0];
+			std::vector<Matrix4> out(count);
+			results.push_back(Measure(options, "matrix4_multiply", count, [&](size_t n)
+			{
+				for (size_t i = 0; i < n; ++i)
+				{
+					out[i] = in[i] * b;
+				}
+				g_Sink = g_Sink + out[n - 1].m11;
+			}));
+			results.push_back(Measure(options, "matrix4_inverse", count, [&](size_t n)
+			{
+				for (size_t i = 0; i < n; ++i)
+				{
+					out[i] = in[i].Inverse();
+				}
+				g_Sink = g_Sink + out[n - 1].m11;
+			}));
+		}
+
+		{
+			const std::vector<Quaternion> rotations = RandomRotations(random, count);
+			const std::vector<Quaternion> other = RandomRotations(random, count);
+			std::vector<AffineTransform> in(count);
+			for (size_t i = 0; i < count; ++i)
+			{
+				in[i] = AffineTransform::FromTRS(Vector3(1.0f, 2.0f, 3.0f), rotations[i], Vector3(1.0f, 1.0f, 1.0f));
+			}
+			const AffineTransform b = in[0];
+			std::vector<AffineTransform> out(count);
+			std::vector<Matrix4> outMatrices(count);
+			std::vector<Quaternion> outRotations(count);
+
+			results.push_back(Measure(options, "affine_multiply", count, [&](size_t n)
+			{
+				for (size_t i = 0; i < n; ++i)
+				{
+					out[i] = in[i] * b;
+				}
+				g_Sink = g_Sink + out[n - 1].rows[0][0];
+			}));
+			results.push_back(Measure(options, "affine_inverse_rigid", count, [&](size_t n)
+			{
+				for (size_t i = 0; i < n; ++i)
+				{
+					out[i] = in[i].InverseRigid();
+				}
+				g_Sink = g_Sink + out[n - 1].rows[0][0];
+			}));
+			results.push_back(Measure(options, "affine_inverse", count, [&](size_t n)
+			{
+				for (size_t i = 0; i < n; ++i)
+				{
+					out[i] = in[i].Inverse();
+				}
+				g_Sink = g_Sink + out[n - 1].rows[0][0];
+			}));
+			results.push_back(Measure(options, "quaternion_to_matrix", count, [&](size_t n)
+			{
+				for (size_t i = 0; i < n; ++i)
+				{
+					outMatrices[i] = rotations[i].GetMatrix();
+				}
+				g_Sink = g_Sink + outMatrices[n - 1].m11;
+			}));
+			results.push_back(Measure(options, "quaternion_to_affine_trs", count, [&](size_t n)
+			{
+				for (size_t i = 0; i < n; ++i)
+				{
+					out[i] = AffineTransform::FromTRS(Vector3(1.0f, 2.0f, 3.0f), rotations[i], Vector3(2.0f, 2.0f, 2.0f));
+				}
+				g_Sink = g_Sink + out[n - 1].rows[0][0];
+			}));
+			results.push_back(Measure(options, "quaternion_multiply_batch", count, [&](size_t n)
+			{
+				Quaternion::MultiplyBatch(rotations.data(), other.data(), outRotations.data(), n);
+				g_Sink = g_Sink + outRotations[n - 1].w;
+			}));
+		}
+
+		{
+			const std::vector<Vector3> a = RandomVectors(random, count);
+			const std::vector<Vector3> b = RandomVectors(random, count);
+			std::vector<Vector3> out(count);
+			results.push_back(Measure(options, "vector3_normalize", count, [&](size_t n)
+			{
+				for (size_t i = 0; i < n; ++i)
+				{
+					out[i] = a[i].GetNormal();
+				}
+				g_Sink = g_Sink + out[n - 1].x;
+			}));
+			results.push_back(Measure(options, "vector3_normalize_fast", count, [&](size_t n)
+			{
+				for (size_t i = 0; i < n; ++i)
+				{
+					out[i] = FastMath::Normalize(a[i]);
+				}
+				g_Sink = g_Sink + out[n - 1].x;
+			}));
+			results.push_back(Measure(options, "vector3_cross", count, [&](size_t n)
+			{
+				for (size_t i = 0; i < n; ++i)
+				{
+					out[i] = a[i].Cross(b[i]);
+				}
+				g_Sink = g_Sink + out[n - 1].x;
+			}));
+		}
+
+		{
+			std::vector<float> x = RandomFloats(random, count, -10.0f, 10.0f);
+			std::vector<float> y = RandomFloats(random, count, -10.0f, 10.0f);
+			std::vector<float> z = RandomFloats(random, count, 10.0f, 30.0f);
+			const std::vector<float> radius = RandomFloats(random, count, 0.5f, 2.0f);
+			std::vector<float> outX(count);
+			std::vector<float> outY(count);
+			std::vector<float> outZ(count);
+			std::vector<uint32_t> visible(count);
+			const Matrix4 matrix = RandomMatrices(random, 1)[0];
+			const ConstVector3Stream in(x.data(), y.data(), z.data());
+			const Vector3Stream out = { outX.data(), outY.data(), outZ.data() };
+
+			results.push_back(Measure(options, "vector3_normalize_fast_batch", count, [&](size_t n)
+			{
+				FastMath::NormalizeBatch(in, out, n);
+				g_Sink = g_Sink + outX[n - 1];
+			}));
+			results.push_back(Measure(options, "transform_points_batch", count, [&](size_t n)
+			{
+				TransformBatch::TransformPoints(matrix, in, out, n);
+				g_Sink = g_Sink + outX[n - 1];
+			}));
+			results.push_back(Measure(options, "transform_points_parallel", count, [&](size_t n)
+			{
+				TransformBatch::TransformPointsParallel(matrix, in, out, n);
+				g_Sink = g_Sink + outX[n - 1];
+			}));
+			results.push_back(Measure(options, "sincos_libm", count, [&](size_t n)
+			{
+				for (size_t i = 0; i < n; ++i)
+				{
+					outX[i] = sin(x[i]);
+					outY[i] = cos(x[i]);
+				}
+				g_Sink = g_Sink + outX[n - 1];
+			}));
+			results.push_back(Measure(options, "sincos_fast_batch", count, [&](size_t n)
+			{
+				FastMath::SinCosBatch(x.data(), outX.data(), outY.data(), n);
+				g_Sink = g_Sink + outX[n - 1];
+			}));
+
+			std::vector<Half> halves(count);
+			results.push_back(Measure(options, "half_pack_batch", count, [&](size_t n)
+			{
+				Half::ToHalfBatch(x.data(), halves.data(), n);
+				g_Sink = g_Sink + static_cast<float>(halves[n - 1].bits);
+			}));
+			results.push_back(Measure(options, "half_unpack_batch", count, [&](size_t n)
+			{
+				Half::ToFloatBatch(halves.data(), outX.data(), n);
+				g_Sink = g_Sink + outX[n - 1];
+			}));
+
+			Camera camera(16.0f / 9.0f);
+			TransformStore::Instance()->UpdateWorldMatrices();
+			const Frustum& frustum = camera.GetFrustum();
+			const SphereStream spheres = { x.data(), y.data(), z.data(), radius.data() };
+			results.push_back(Measure(options, "frustum_cull_spheres", count, [&](size_t n)
+			{
+				g_Sink = g_Sink + static_cast<float>(frustum.CullSpheres(spheres, static_cast<uint32_t>(n), visible.data()));
+			}));
+		}
+
+		{
+			//Four children per node, breadth first, so the hierarchy is about log4(count) deep
+			TransformStore& store = *TransformStore::Instance();
+			const std::vector<Quaternion> rotations = RandomRotations(random, count);
+			std::vector<TransformHandle> nodes(count);
+			for (size_t i = 0; i < count; ++i)
+			{
+				nodes[i] = store.Create(i == 0 ? TransformHandle() : nodes[(i - 1) / 4]);
+				store.SetLocalTRS(nodes[i], Vector3(1.0f, 0.0f, 0.0f), rotations[i], Vector3(1.0f, 1.0f, 1.0f));
+			}
+			store.UpdateWorldMatrices();
+
+			results.push_back(Measure(options, "transform_store_update_all", count, [&](size_t n)
+			{
+				store.SetLocalRotation(nodes[0], rotations[n - 1]);
+				store.UpdateWorldMatrices();
+				g_Sink = g_Sink + store.GetWorldMatrix(nodes[n - 1]).rows[0][0];
+			}));
+			//Moves one leaf in a hundred, what a mostly static scene pays
+			const size_t firstLeaf = count / 4;
+			results.push_back(Measure(options, "transform_store_update_sparse", count, [&](size_t n)
+			{
+				for (size_t i = firstLeaf; i < n; i += 100)
+				{
+					store.SetLocalRotation(nodes[i], rotations[i - firstLeaf]);
+				}
+				store.UpdateWorldMatrices();
+				g_Sink = g_Sink + store.GetWorldMatrix(nodes[n - 1]).rows[0][0];
+			}));
+			//What Draw pays per visible object to draw between the last two simulation steps
+			store.BeginSimulationStep();
+			store.SetLocalRotation(nodes[0], rotations[0]);
+			store.UpdateWorldMatrices();
+			results.push_back(Measure(options, "transform_store_interpolate", count, [&](size_t n)
+			{
+				float sum = 0.0f;
+				for (size_t i = 0; i < n; ++i)
+				{
+					sum += store.GetInterpolatedWorldMatrix(nodes[i], 0.5f).rows[0][3];
+				}
+				g_Sink = g_Sink + sum;
+			}));
+			store.Destroy(nodes[0]);
+		}
+
+		{
+			//Same update over heap objects holding hot and cold data together, then over packed archetype chunks
+			EntityWorld& world = *EntityWorld::Instance();
+			const std::vector<Vector3> velocities = RandomVectors(random, count);
+			std::vector<std::unique_ptr<BenchmarkObject>> objects;
+			std::vector<Entity> entities;
+			for (size_t i = 0; i < count; ++i)
+			{
+				objects.emplace_back(new BenchmarkObject());
+				objects.back()->mMotion = BenchmarkMotion{ Vector3(0.0f, 0.0f, 0.0f), velocities[i] };
+				entities.push_back(world.CreateEntity(BenchmarkMotion{ Vector3(0.0f, 0.0f, 0.0f), velocities[i] }, BenchmarkMesh()));
+			}
+			std::shuffle(objects.begin(), objects.end(), random);
+
+			results.push_back(Measure(options, "object_pointer_update", count, [&](size_t n)
+			{
+				for (size_t i = 0; i < n; ++i)
+				{
+					BenchmarkMotion& motion = objects[i]->mMotion;
+					motion.mPosition = motion.mPosition + (motion.mVelocity * 0.016f);
+				}
+				g_Sink = g_Sink + objects[n - 1]->mMotion.mPosition.x;
+			}));
+			results.push_back(Measure(options, "entity_world_update", count, [&](size_t)
+			{
+				world.ForEachChunk<BenchmarkMotion>([](uint32_t chunkCount, const Entity*, BenchmarkMotion* motions)
+				{
+					for (uint32_t i = 0; i < chunkCount; ++i)
+					{
+						motions[i].mPosition = motions[i].mPosition + (motions[i].mVelocity * 0.016f);
+					}
+				});
+				g_Sink = g_Sink + world.Get<BenchmarkMotion>(entities.back())->mPosition.x;
+			}));
+			for (Entity entity : entities)
+			{
+				world.DestroyEntity(entity);
+			}
+		}
+
+		{
+			//RenderObject::UpdateAll's spin on one thread writing straight to the store, then spread over the job threads
+			//with the rotations gathered per thread and written afterwards
+			EntityWorld& world = *EntityWorld::Instance();
+			TransformStore& store = *TransformStore::Instance();
+			//Parented to one root so tearing them down is a single Destroy
+			const TransformHandle root = store.Create();
+			std::vector<Entity> entities;
+			for (size_t i = 0; i < count; ++i)
+			{
+				entities.push_back(world.CreateEntity(BenchmarkSpin{ static_cast<float>(i % 360), 45.0f }, store.Create(root)));
+			}
+
+			results.push_back(Measure(options, "spin_update_serial", count, [&](size_t)
+			{
+				world.ForEachChunk<BenchmarkSpin, TransformHandle>([&store](uint32_t chunkCount, const Entity*, BenchmarkSpin* spins, TransformHandle* transforms)
+				{
+					for (uint32_t i = 0; i < chunkCount; ++i)
+					{
+						AdvanceSpin(spins[i]);
+						store.SetLocalRotation(transforms[i], Quaternion::FromAngleAxisFast(spins[i].mAngleX, up) * Quaternion::FromAngleAxisFast(spins[i].mAngleY, right));
+					}
+				});
+				g_Sink = g_Sink + store.GetLocalRotation(*world.Get<TransformHandle>(entities.back())).w;
+			}));
+			PerThread<BenchmarkRotationWrites> writes;
+			results.push_back(Measure(options, "spin_update_parallel", count, [&](size_t)
+			{
+				world.ParallelForEachChunk<BenchmarkSpin, TransformHandle>([&writes](uint32_t chunkCount, const Entity*, BenchmarkSpin* spins, TransformHandle* transforms)
+				{
+					BenchmarkRotationWrites& local = writes.Local();
+					for (uint32_t i = 0; i < chunkCount; ++i)
+					{
+						AdvanceSpin(spins[i]);
+						local.mTransforms.push_back(transforms[i]);
+						local.mRotations.push_back(Quaternion::FromAngleAxisFast(spins[i].mAngleX, up) * Quaternion::FromAngleAxisFast(spins[i].mAngleY, right));
+					}
+				});
+				for (uint32_t thread = 0; thread < writes.GetCount(); ++thread)
+				{
+					store.SetLocalRotations(writes[thread].mTransforms.data(), writes[thread].mRotations.data(), static_cast<uint32_t>(writes[thread].mTransforms.size()));
+					writes[thread].mTransforms.clear();
+					writes[thread].mRotations.clear();
+				}
+				g_Sink = g_Sink + store.GetLocalRotation(*world.Get<TransformHandle>(entities.back())).w;
+			}));
+
+			store.Destroy(root);
+			for (Entity entity : entities)
+			{
+				world.DestroyEntity(entity);
+			}
+		}
+
+		//Each call starts its own threads, below this that is all that gets measured
+		if (count >= 10000)
+		{
+			SPSCQueue<uint64_t, 1024> spsc;
+			results.push_back(Measure(options, "spsc_queue_transfer", count, [&](size_t n)
+			{
+				g_Sink = g_Sink + static_cast<float>(TransferThroughQueue(spsc, n, 1, 1));
+			}));
+			MPMCQueue<uint64_t, 1024> mpmc;
+			results.push_back(Measure(options, "mpmc_queue_transfer_2x2", count, [&](size_t n)
+			{
+				g_Sink = g_Sink + static_cast<float>(TransferThroughQueue(mpmc, n, 2, 2));
+			}));
+			MutexQueue locked;
+			results.push_back(Measure(options, "mutex_queue_transfer_2x2", count, [&](size_t n)
+			{
+				g_Sink = g_Sink + static_cast<float>(TransferThroughQueue(locked, n, 2, 2));
+			}));
+		}
+
+		{
+			//64 byte blocks, a frame ends and is released whenever the ring fills
+			FrameRingAllocator ring(1 << 20);
+			results.push_back(Measure(options, "frame_ring_allocate", count, [&](size_t n)
+			{
+				for (size_t i = 0; i < n; ++i)
+				{
+					void* block = ring.Allocate(64);
+					if (block == nullptr)
+					{
+						ring.ReleaseFrame(ring.EndFrame());
+						block = ring.Allocate(64);
+					}
+					static_cast<uint8_t*>(block)[0] = static_cast<uint8_t>(i);
+				}
+				g_Sink = g_Sink + static_cast<float>(ring.GetUsed());
+			}));
+		}
+
+		{
+			//One op is a yaw, the world matrix update and a full rebuild of the cached matrices, what a frame of mouse look costs
+			Camera camera(16.0f / 9.0f);
+			results.push_back(Measure(options, "camera_rotate_and_build", count, [&](size_t n)
+			{
+				for (size_t i = 0; i < n; ++i)
+				{
+					camera.RotateYaw(0.01f);
+					TransformStore::Instance()->UpdateWorldMatrices();
+					g_Sink = g_Sink + camera.GetViewProjection().m11;
+				}
+			}));
+			results.push_back(Measure(options, "camera_projection_build", count, [&](size_t n)
+			{
+				for (size_t i = 0; i < n; ++i)
+				{
+					camera.SetFov(50.0f + static_cast<float>(i & 7));
+					g_Sink = g_Sink + camera.GetViewProjection().m11;
+				}
+			}));
+		}
+	}
+
+	std::string ResultKey(const std::string& name, size_t count)
+	{
+		return name + "/" + std::to_string(count);
+	}
+
+	//Reads back the one-result-per-line layout written by WriteJson
+	std::map<std::string, double> LoadBaseline(const std::string& path)
+	{
+		std::map<std::string, double> baseline;
+		std::ifstream file(path);
+		std::string line;
+		while (std::getline(file, line))
+		{
+			const size_t namePos = line.find("\"name\": \"");
+			const size_t countPos = line.find("\"count\": ");
+			const size_t nsPos = line.find("\"ns_per_op\": ");
+			if (namePos == std::string::npos || countPos == std::string::npos || nsPos == std::string::npos)
+			{
+				continue;
+			}
+			const size_t nameStart = namePos + 9;
+			const std::string name = line.substr(nameStart, line.find('"', nameStart) - nameStart);
+			const size_t count = std::stoull(line.substr(countPos + 9));
+			baseline[ResultKey(name, count)] = std::stod(line.substr(nsPos + 13));
+		}
+		return baseline;
+	}
+
+	void WriteJson(const Options& options, const std::vector<Result>& results)
+	{
+		std::ofstream file(options.mJsonPath);
+		file << "{\n";
+		file << "\t\"simd\": \"" << SimdPath() << "\",\n";
+		file << "\t\"results\": [\n";
+		for (size_t i = 0; i < results.size(); ++i)
+		{
+			const Result& result = results[i];
+			char line[256];
+			snprintf(line, sizeof(line), "\t\t{ \"name\": \"%s\", \"count\": %zu, \"ns_per_op\": %.4f, \"ops_per_second\": %.1f, \"operations\": %llu }%s\n",
+				result.mName.c_str(), result.mCount, result.mNsPerOp, result.mOpsPerSecond, static_cast<unsigned long long>(result.mOperations),
+				i + 1 < results.size() ? "," : "");
+			file << line;
+		}
+		file << "\t]\n}\n";
+	}
+
+	void PrintUsage()
+	{
+		printf("MathBenchmark [--json path] [--baseline path] [--max-count n] [--quick]\n");
+	}
+}
+
+int main(int argc, char** argv)
+{
+	Options options;
+	for (int i = 1; i < argc; ++i)
+	{
+		const std::string arg = argv[i];
+		if (arg == "--json" && i + 1 < argc)
+		{
+			options.mJsonPath = argv[++i];
+		}
+		else if (arg == "--baseline" && i + 1 < argc)
+		{
+			options.mBaselinePath = argv[++i];
+		}
+		else if (arg == "--max-count" && i + 1 < argc)
+		{
+			options.mMaxCount = std::stoull(argv[++i]);
+		}
+		else if (arg == "--quick")
+		{
+			options.mMinTrialSeconds = 0.001;
+			options.mTrials = 3;
+		}
+		else
+		{
+			PrintUsage();
+			return 1;
+		}
+	}
+
+	JobSystem::CreateInstance();
+	TransformStore::CreateInstance();
+	EntityWorld::CreateInstance();
+	const std::map<std::string, double> baseline = options.mBaselinePath.empty() ? std::map<std::string, double>() : LoadBaseline(options.mBaselinePath);
+
+	printf("simd path: %s, %u job threads\n", SimdPath(), JobSystem::Instance()->GetThreadCount());
+	printf("%-30s %9s %12s %14s %10s\n", "operation", "count", "ns/op", "ops/s", "vs base");
+
+	std::vector<Result> results;
+	for (size_t count = 1; count <= options.mMaxCount; count *= 10)
+	{
+		const size_t first = results.size();
+		RunSize(options, count, results);
+		for (size_t i = first; i < results.size(); ++i)
+		{
+			const Result& result = results[i];
+			const auto base = baseline.find(ResultKey(result.mName, result.mCount));
+			char speedup[32] = "-";
+			if (base != baseline.end())
+			{
+				snprintf(speedup, sizeof(speedup), "%.2fx", base->second / result.mNsPerOp);
+			}
+			printf("%-30s %9zu %12.3f %14.0f %10s\n", result.mName.c_str(), result.mCount, result.mNsPerOp, result.mOpsPerSecond, speedup);
+		}
+	}
+
+	WriteJson(options, results);
+	printf("wrote %s (sink %f)\n", options.mJsonPath.c_str(), static_cast<double>(g_Sink));
+	return 0;
+}
\ No newline at end of file
@@ -8,7 +8,12 @@ namespace hal
 		VkCommandPool mCommandPool;
 		VkCommandPoolCreateInfo mCommandPoolCI = {}; //pull to layout
 	public:
-		CommandPool(uint32_t queueFamilyIndex);
+		//!The default lets each command buffer be re-recorded on its own. A pool made with VK_COMMAND_POOL_CREATE_TRANSIENT_BIT
+		//!alone is meant to be Reset whole instead, every buffer from it recorded again after.
+		CommandPool(uint32_t queueFamilyIndex, VkCommandPoolCreateFlags flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT);
 		const VkCommandPool& GetVKCommandPool() const { return mCommandPool; }
+
+		//!Puts every command buffer from the pool back to the initial state in one go. None may still be in use by the GPU.
+		void Reset();
 	};
 }
\ No newline at end of file
@@ -31,7 +31,7 @@ namespace hal
 	{
 	private:
 		friend class DrawBuffer;
-		static const DrawInfo* mCurrentDrawInfo;
+		static thread_local const DrawInfo* mCurrentDrawInfo; //Per thread so buffers can be recorded on several at once
 		static const VkBuffer* GetBuffer(BufferType bufferType, uint32_t index);
 		static uint32_t GetBufferLength(BufferType bufferType, uint32_t index);
 	public:
@@ -9,18 +9,26 @@ namespace hal
 	class DrawBuffer
 	{
 	private:
-		const CommandPool* mCommandPool;
-		VkCommandBuffer mCommandBuffer;
-		VkCommandBufferAllocateInfo mCommandBufferAllocateInfo; //Move to own layout
-		VkCommandBufferBeginInfo mCommandBufferInfo;
+		std::vector<VkCommandBuffer> vCommandBuffers; //One, or one per frame in flight
+		VkCommandBufferAllocateInfo mCommandBufferAllocateInfo = {}; //Move to own layout
+		VkCommandBufferBeginInfo mCommandBufferInfo = {};
 		std::vector<const DrawInfo*> vDrawInfos;
+
+		void AllocateCommandBuffer(const CommandPool* commandPool, VkCommandBufferLevel level);
 	public:
 		DrawBuffer() = default;
-		DrawBuffer(const CommandPool* commandPool, const std::vector<const DrawInfo*>& drawInfo);
+		//!A single command buffer from commandPool. Only re-record it once the GPU is done with every frame that used it.
+		DrawBuffer(const CommandPool* commandPool, const std::vector<const DrawInfo*>& drawInfo, VkCommandBufferLevel level = VK_COMMAND_BUFFER_LEVEL_PRIMARY);
+		//!A command buffer per frame in flight from the Render frame pools. BeginFrame resets them, so record it every frame after Render::BeginFrame
+		DrawBuffer(const std::vector<const DrawInfo*>& drawInfo);
 
+		//!The command buffer for the current frame in flight
 		const VkCommandBuffer& GetCommandBuffer() const;
 
 		void StartDrawBuffer();
+		//!Starts a secondary buffer that continues the render pass in inheritanceInfo, for recording one frame on many threads.
+		//!Pass 0 for usage to record a buffer once and execute it again every frame.
+		void StartDrawBuffer(const VkCommandBufferInheritanceInfo& inheritanceInfo, VkCommandBufferUsageFlags usage = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
 		
 		//Sends command to all DrawInfos
 		template<typename TFPTR, typename ...ARGS>
@@ -30,6 +38,14 @@ namespace hal
 		template<typename TFPTR, typename ...ARGS>
 		void RecordSingleVulkanCommand(uint32_t index, TFPTR&& vkCmd, ARGS&& ...args);
 
+		//Send command once, for commands that don't use placeholders
+		template<typename TFPTR, typename ...ARGS>
+		void RecordCommand(TFPTR&& vkCmd, ARGS&& ...args);
+
+		//Send command with placeholders looked up in a DrawInfo the buffer doesn't own, for recording many objects into one buffer
+		template<typename TFPTR, typename ...ARGS>
+		void RecordDrawInfoCommand(const DrawInfo& drawInfo, TFPTR&& vkCmd, ARGS&& ...args);
+
 		void EndDrawBuffer();
 		~DrawBuffer() = default;
 	};
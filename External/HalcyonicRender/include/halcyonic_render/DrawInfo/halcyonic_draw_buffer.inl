@@ -1,10 +1,11 @@
 template<typename TFPTR, typename ...ARGS>
 inline void hal::DrawBuffer::RecordVulkanCommands(TFPTR&& vkCmd, ARGS&& ...args)
 {
+	const VkCommandBuffer commandBuffer = GetCommandBuffer();
 	for (const DrawInfo* di : vDrawInfos)
 	{
 		DrawCommand::mCurrentDrawInfo = di;
-		vkCmd(mCommandBuffer, args...);
+		vkCmd(commandBuffer, args...);
 	}
 }
 
@@ -12,5 +13,18 @@ template<typename TFPTR, typename ...ARGS>
 inline void hal::DrawBuffer::RecordSingleVulkanCommand(uint32_t index, TFPTR&& vkCmd, ARGS&& ...args)
 {
 	DrawCommand::mCurrentDrawInfo = vDrawInfos[index];
-	vkCmd(mCommandBuffer, args...);
+	vkCmd(GetCommandBuffer(), args...);
+}
+
+template<typename TFPTR, typename ...ARGS>
+inline void hal::DrawBuffer::RecordCommand(TFPTR&& vkCmd, ARGS&& ...args)
+{
+	vkCmd(GetCommandBuffer(), args...);
+}
+
+template<typename TFPTR, typename ...ARGS>
+inline void hal::DrawBuffer::RecordDrawInfoCommand(const DrawInfo& drawInfo, TFPTR&& vkCmd, ARGS&& ...args)
+{
+	DrawCommand::mCurrentDrawInfo = &drawInfo;
+	vkCmd(GetCommandBuffer(), args...);
 }
\ No newline at end of file
@@ -11,6 +11,10 @@ namespace hal
 		VkDescriptorBufferInfo mDescriptorBufferInfo = {};
 	public:
 		BufferDescriptor(const DescriptorLayout* descriptorLayout, const Buffer* buffer);
+		//!range limits each read of the buffer, used with dynamic offsets into a larger buffer
+		BufferDescriptor(const DescriptorLayout* descriptorLayout, const Buffer* buffer, VkDeviceSize range);
+		//!Points the descriptor at another buffer, the owning DescriptorPool must call WriteDescriptorSet afterwards
+		void SetBuffer(const Buffer* buffer, VkDeviceSize range);
 		const VkDescriptorBufferInfo& GetDescriptorBufferInfo() const { return mDescriptorBufferInfo; }
 	};
 }
\ No newline at end of file
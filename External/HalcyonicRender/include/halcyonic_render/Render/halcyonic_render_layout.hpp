@@ -16,12 +16,13 @@ namespace hal
 
 		uint32_t mRenderWidth = 1920;
 		uint32_t mRenderHeight = 1080;
+		uint32_t mFramesInFlight = 2; //How many frames the CPU can record ahead of the GPU
 
 		bool mEnableVSync = false;
 		bool mEnableValidation = false;
 
 		FramebufferLayout* mSwapchainFramebufferLayout;
 	public:
-		RenderLayout(VkFormat colourFormat = VK_FORMAT_R8G8B8A8_UNORM, VkFormat depthFormat = VK_FORMAT_D32_SFLOAT_S8_UINT, std::vector<VkClearValue> clearValues = { {0.1f, 0.1f, 0.1f, 1.0f}, {1.0f, 0} }, uint32_t mRenderWidth = 1920, uint32_t mRenderHeight = 1080, bool enableVSync = false, bool enableValidation = false);
+		RenderLayout(VkFormat colourFormat = VK_FORMAT_R8G8B8A8_UNORM, VkFormat depthFormat = VK_FORMAT_D32_SFLOAT_S8_UINT, std::vector<VkClearValue> clearValues = { {0.1f, 0.1f, 0.1f, 1.0f}, {1.0f, 0} }, uint32_t mRenderWidth = 1920, uint32_t mRenderHeight = 1080, bool enableVSync = false, bool enableValidation = false, uint32_t framesInFlight = 2);
 	};
 }
\ No newline at end of file
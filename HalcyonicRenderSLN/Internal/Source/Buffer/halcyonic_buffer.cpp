@@ -37,9 +37,16 @@ hal::Buffer::Buffer(uint32_t size, uint8_t * pData, BufferType bufferType, VkSha
 
 void hal::Buffer::UpdateBuffer(uint8_t * pData)
 {
+	UpdateBuffer(pData, 0, mBufferSize);
+}
+
+void hal::Buffer::UpdateBuffer(const uint8_t * pData, uint32_t offset, uint32_t size)
+{
+	HALCYONIC_DEBUG((offset + size <= mBufferSize), "Buffer: Update is out of range");
 	void* mappedData = nullptr;
-	HALCYONIC_VK_CHECK(vmaMapMemory(Render::Instance()->GetAllocator(), mAllocation, &mappedData), "Buffer: Could not map Vma memory");
-	memcpy(mappedData, pData, mBufferSize);
+	const VkResult result = vmaMapMemory(Render::Instance()->GetAllocator(), mAllocation, &mappedData);
+	HALCYONIC_VK_CHECK(result, "Buffer: Could not map Vma memory");
+	memcpy(static_cast<uint8_t*>(mappedData) + offset, pData, size);
 	vmaUnmapMemory(Render::Instance()->GetAllocator(), mAllocation);
 }
 
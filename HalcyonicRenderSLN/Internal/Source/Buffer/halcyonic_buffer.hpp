@@ -13,7 +13,7 @@ namespace hal
 		IndirectBuffer = VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT
 	};
 
-	class Buffer //Todo: add offset
+	class Buffer
 	{
 	private:
 		VmaAllocation mAllocation;
@@ -32,6 +32,8 @@ namespace hal
 		uint32_t GetBufferSize() const { return mBufferSize; }
 
 		void UpdateBuffer(uint8_t* pData);
+		//!Copies size bytes from pData into the buffer starting at offset
+		void UpdateBuffer(const uint8_t* pData, uint32_t offset, uint32_t size);
 
 		~Buffer();
 	};
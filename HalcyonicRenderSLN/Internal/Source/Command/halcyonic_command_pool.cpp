@@ -2,11 +2,18 @@
 #include <Render/halcyonic_render.hpp>
 #include<Command/halcyonic_command_pool.hpp>
 
-hal::CommandPool::CommandPool(uint32_t queueFamilyIndex)
+hal::CommandPool::CommandPool(uint32_t queueFamilyIndex, VkCommandPoolCreateFlags flags)
 {
-	mCommandPoolCI.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+	mCommandPoolCI.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
 	mCommandPoolCI.queueFamilyIndex = queueFamilyIndex;
-	mCommandPoolCI.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+	mCommandPoolCI.flags = flags;
 
-	HALCYONIC_VK_CHECK(vkCreateCommandPool(Render::Instance()->GetVulkanDevice().GetLogicalDevice(), &mCommandPoolCI, nullptr, &mCommandPool), "CommandPool: Could not create command pool");
+	const VkResult result = vkCreateCommandPool(Render::Instance()->GetVulkanDevice().GetLogicalDevice(), &mCommandPoolCI, nullptr, &mCommandPool);
+	HALCYONIC_VK_CHECK(result, "CommandPool: Could not create command pool");
+}
+
+void hal::CommandPool::Reset()
+{
+	const VkResult result = vkResetCommandPool(Render::Instance()->GetVulkanDevice().GetLogicalDevice(), mCommandPool, 0);
+	HALCYONIC_VK_CHECK(result, "CommandPool: Could not reset command pool");
 }
@@ -5,7 +5,7 @@
 
 using namespace hal;
 
-const DrawInfo* DrawCommand::mCurrentDrawInfo = nullptr;
+thread_local const DrawInfo* DrawCommand::mCurrentDrawInfo = nullptr;
 
 const VkBuffer* DrawCommand::GetBuffer(BufferType bufferType, uint32_t index)
 {
@@ -13,6 +13,12 @@ hal::SetupCommandBuffer::SetupCommandBuffer(const CommandPool * commandPool): mC
 	HALCYONIC_VK_CHECK(vkAllocateCommandBuffers(Render::Instance()->GetVulkanDevice().GetLogicalDevice(), &mCommandBufferAllocateInfo, &mCommandBuffer), "SetupCommandBuffer: Could not allocate command buffer");
 
 	mCommandBufferInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+
+	VkFenceCreateInfo fenceCreateInfo = {};
+	fenceCreateInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+	//The checks compile out in release, so the calls are kept outside them
+	const VkResult result = vkCreateFence(Render::Instance()->GetVulkanDevice().GetLogicalDevice(), &fenceCreateInfo, nullptr, &mFence);
+	HALCYONIC_VK_CHECK(result, "SetupCommandBuffer: Could not create fence");
 }
 
 void hal::SetupCommandBuffer::StartSetupBuffer()
@@ -21,6 +27,14 @@ void hal::SetupCommandBuffer::StartSetupBuffer()
 }
 
 void hal::SetupCommandBuffer::EndAndSubmitSetupBuffer()
+{
+	EndAndSubmitSetupBufferAsync();
+	//Only this submit, not everything else on the queue
+	const VkResult result = vkWaitForFences(hal::Render::Instance()->GetVulkanDevice().GetLogicalDevice(), 1, &mFence, VK_TRUE, UINT64_MAX);
+	HALCYONIC_VK_CHECK(result, "SetupCommandBuffer: Wait for fence failed");
+}
+
+void hal::SetupCommandBuffer::EndAndSubmitSetupBufferAsync()
 {
 	vkEndCommandBuffer(mCommandBuffer);
 
@@ -29,12 +43,22 @@ void hal::SetupCommandBuffer::EndAndSubmitSetupBuffer()
 	submitInfo.commandBufferCount = 1;
 	submitInfo.pCommandBuffers = &mCommandBuffer;
 
-	vkQueueSubmit(hal::Render::Instance()->GetVulkanQueue(), 1, &submitInfo, VK_NULL_HANDLE);
-	vkQueueWaitIdle(hal::Render::Instance()->GetVulkanQueue());
+	VkResult result = vkResetFences(hal::Render::Instance()->GetVulkanDevice().GetLogicalDevice(), 1, &mFence);
+	HALCYONIC_VK_CHECK(result, "SetupCommandBuffer: Reset fence failed");
+	result = vkQueueSubmit(hal::Render::Instance()->GetVulkanQueue(), 1, &submitInfo, mFence);
+	HALCYONIC_VK_CHECK(result, "SetupCommandBuffer: Queue submit failed");
+}
+
+bool hal::SetupCommandBuffer::IsComplete() const
+{
+	//A zero timeout only polls, VK_TIMEOUT means still running
+	return vkWaitForFences(hal::Render::Instance()->GetVulkanDevice().GetLogicalDevice(), 1, &mFence, VK_TRUE, 0) == VK_SUCCESS;
 }
 
 hal::SetupCommandBuffer::~SetupCommandBuffer()
 {
 	vkFreeCommandBuffers(hal::Render::Instance()->GetVulkanDevice().GetLogicalDevice(), mCommandPool->GetVKCommandPool(), 1, &mCommandBuffer);
 	mCommandBuffer = VK_NULL_HANDLE;
+	vkDestroyFence(hal::Render::Instance()->GetVulkanDevice().GetLogicalDevice(), mFence, nullptr);
+	mFence = VK_NULL_HANDLE;
 }
@@ -8,6 +8,7 @@ namespace hal
 	private:
 		const CommandPool* mCommandPool;
 		VkCommandBuffer mCommandBuffer;
+		VkFence mFence; //Signalled when the last submit finishes
 		VkCommandBufferAllocateInfo mCommandBufferAllocateInfo = {}; //Move to shared layout
 		VkCommandBufferBeginInfo mCommandBufferInfo = {};
 	public:
@@ -16,7 +17,11 @@ namespace hal
 		const VkCommandBuffer& GetVulkanCommandBuffer() const { return mCommandBuffer; }
 
 		void StartSetupBuffer();
+		//!Submits and waits for the GPU to finish it
 		void EndAndSubmitSetupBuffer();
+		//!Submits without waiting. The buffer and everything it uses have to stay alive until IsComplete returns true.
+		void EndAndSubmitSetupBufferAsync();
+		bool IsComplete() const;
 		~SetupCommandBuffer();
 	};
 }
\ No newline at end of file
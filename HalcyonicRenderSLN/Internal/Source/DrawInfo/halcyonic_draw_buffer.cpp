@@ -6,36 +6,68 @@
 
 using namespace hal;
 
-hal::DrawBuffer::DrawBuffer(const CommandPool* commandPool, const std::vector<const DrawInfo*>& drawInfo): mCommandPool(commandPool)
+void hal::DrawBuffer::AllocateCommandBuffer(const CommandPool* commandPool, VkCommandBufferLevel level)
 {
-	vDrawInfos.resize(drawInfo.size());
-	for (uint32_t i = 0; i < drawInfo.size(); ++i)
-	{
-		vDrawInfos[i] = drawInfo[i];
-	}
 	mCommandBufferAllocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-	mCommandBufferAllocateInfo.commandPool = mCommandPool->GetVKCommandPool();
-	mCommandBufferAllocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+	mCommandBufferAllocateInfo.commandPool = commandPool->GetVKCommandPool();
+	mCommandBufferAllocateInfo.level = level;
 	mCommandBufferAllocateInfo.commandBufferCount = 1;
 
-	HALCYONIC_VK_CHECK(vkAllocateCommandBuffers(Render::Instance()->GetVulkanDevice().GetLogicalDevice(), &mCommandBufferAllocateInfo, &mCommandBuffer), "DrawBuffer: Could not allocate command buffer");
+	VkCommandBuffer commandBuffer;
+	const VkResult result = vkAllocateCommandBuffers(Render::Instance()->GetVulkanDevice().GetLogicalDevice(), &mCommandBufferAllocateInfo, &commandBuffer);
+	HALCYONIC_VK_CHECK(result, "DrawBuffer: Could not allocate command buffer");
+	vCommandBuffers.push_back(commandBuffer);
+}
+
+hal::DrawBuffer::DrawBuffer(const CommandPool* commandPool, const std::vector<const DrawInfo*>& drawInfo, VkCommandBufferLevel level) : vDrawInfos(drawInfo)
+{
+	AllocateCommandBuffer(commandPool, level);
+}
+
+hal::DrawBuffer::DrawBuffer(const std::vector<const DrawInfo*>& drawInfo) : vDrawInfos(drawInfo)
+{
+	const uint32_t framesInFlight = Render::Instance()->GetFramesInFlight();
+	vCommandBuffers.reserve(framesInFlight);
+	for (uint32_t i = 0; i < framesInFlight; ++i)
+	{
+		AllocateCommandBuffer(Render::Instance()->GetFrameCommandPool(i), VK_COMMAND_BUFFER_LEVEL_PRIMARY);
+	}
 }
 
 const VkCommandBuffer & hal::DrawBuffer::GetCommandBuffer() const
 {
-	return mCommandBuffer;
+	if (vCommandBuffers.size() == 1)
+	{
+		return vCommandBuffers[0];
+	}
+	return vCommandBuffers[Render::Instance()->GetCurrentFrame()];
 }
 
 void hal::DrawBuffer::StartDrawBuffer()
 {
 	mCommandBufferInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
 	mCommandBufferInfo.pNext = nullptr;
+	mCommandBufferInfo.flags = 0;
+	mCommandBufferInfo.pInheritanceInfo = nullptr;
+
+	const VkResult result = vkBeginCommandBuffer(GetCommandBuffer(), &mCommandBufferInfo);
+	HALCYONIC_VK_CHECK(result, "DrawBuffer: Could not start command buffer");
+}
+
+void hal::DrawBuffer::StartDrawBuffer(const VkCommandBufferInheritanceInfo& inheritanceInfo, VkCommandBufferUsageFlags usage)
+{
+	mCommandBufferInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	mCommandBufferInfo.pNext = nullptr;
+	mCommandBufferInfo.flags = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT | usage;
+	mCommandBufferInfo.pInheritanceInfo = &inheritanceInfo;
 
-	HALCYONIC_VK_CHECK(vkBeginCommandBuffer(mCommandBuffer, &mCommandBufferInfo), "DrawBuffer: Could not start command buffer");
+	const VkResult result = vkBeginCommandBuffer(GetCommandBuffer(), &mCommandBufferInfo);
+	HALCYONIC_VK_CHECK(result, "DrawBuffer: Could not start secondary command buffer");
 }
 
 void hal::DrawBuffer::EndDrawBuffer()
 {
-	HALCYONIC_VK_CHECK(vkEndCommandBuffer(mCommandBuffer), "DrawBuffer: Could not end command buffer");
+	const VkResult result = vkEndCommandBuffer(GetCommandBuffer());
+	HALCYONIC_VK_CHECK(result, "DrawBuffer: Could not end command buffer");
 }
 
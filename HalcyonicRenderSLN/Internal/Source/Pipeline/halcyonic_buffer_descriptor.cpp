@@ -5,9 +5,19 @@
 
 using namespace hal;
 
-hal::BufferDescriptor::BufferDescriptor(const DescriptorLayout* descriptorLayout, const Buffer * buffer) : Descriptor(descriptorLayout), mBuffer(buffer)
+hal::BufferDescriptor::BufferDescriptor(const DescriptorLayout* descriptorLayout, const Buffer * buffer) : BufferDescriptor(descriptorLayout, buffer, static_cast<VkDeviceSize>(buffer->GetBufferSize()))
 {
+}
+
+hal::BufferDescriptor::BufferDescriptor(const DescriptorLayout* descriptorLayout, const Buffer * buffer, VkDeviceSize range) : Descriptor(descriptorLayout), mBuffer(nullptr)
+{
+	SetBuffer(buffer, range);
+}
+
+void hal::BufferDescriptor::SetBuffer(const Buffer * buffer, VkDeviceSize range)
+{
+	mBuffer = buffer;
 	mDescriptorBufferInfo.buffer = *mBuffer->GetVkBuffer();
 	mDescriptorBufferInfo.offset = 0;
-	mDescriptorBufferInfo.range = static_cast<VkDeviceSize>(mBuffer->GetBufferSize());
+	mDescriptorBufferInfo.range = range;
 }
@@ -44,6 +44,11 @@ hal::DescriptorPool::DescriptorPool(std::vector<const Descriptor*> descriptorSet
 
 	HALCYONIC_VK_CHECK(vkAllocateDescriptorSets(Render::Instance()->GetVulkanDevice().GetLogicalDevice(), &mDescriptorAllocInfo, &mDescriptorSet), "DescriptorPool: Could not allocate descriptor set");
 
+	WriteDescriptorSet();
+}
+
+void hal::DescriptorPool::WriteDescriptorSet()
+{
 	std::vector<VkWriteDescriptorSet> writeDescriptorSets;
 	writeDescriptorSets.resize(mSetSize);
 	auto writeDescriptorIterator = writeDescriptorSets.begin();
@@ -56,7 +61,7 @@ hal::DescriptorPool::DescriptorPool(std::vector<const Descriptor*> descriptorSet
 			writeDescriptorIterator->dstSet = mDescriptorSet;
 			writeDescriptorIterator->descriptorCount = 1;
 			writeDescriptorIterator->descriptorType = static_cast<VkDescriptorType>(setTypePair.first);
-			if (setTypePair.first == LayoutBindingDescriptor::UniformBuffer)
+			if (setTypePair.first == LayoutBindingDescriptor::UniformBuffer || setTypePair.first == LayoutBindingDescriptor::DynamicUniformBuffer)
 			{
 				writeDescriptorIterator->pBufferInfo = &reinterpret_cast<const BufferDescriptor*>(ds)->GetDescriptorBufferInfo();
 			}
@@ -69,5 +74,5 @@ hal::DescriptorPool::DescriptorPool(std::vector<const Descriptor*> descriptorSet
 		}
 	}
 
-	vkUpdateDescriptorSets(Render::Instance()->GetVulkanDevice().GetLogicalDevice(), static_cast<uint32_t>(writeDescriptorSets.size()), writeDescriptorSets.data(), 0, nullptr); //need a way to be able to update sets
+	vkUpdateDescriptorSets(Render::Instance()->GetVulkanDevice().GetLogicalDevice(), static_cast<uint32_t>(writeDescriptorSets.size()), writeDescriptorSets.data(), 0, nullptr);
 }
\ No newline at end of file
@@ -17,6 +17,8 @@ namespace hal
 		uint32_t mSetSize;
 	public:
 		DescriptorPool(std::vector<const Descriptor*> descriptorSets, PipelineLayout* pipelineLayout);
+		//!Rewrites the set from its descriptors, call after changing a descriptor and only while the set is not in use by the GPU
+		void WriteDescriptorSet();
 		const VkDescriptorSet& GetVKDescriptorSet() const { return mDescriptorSet; }
 		const VkDescriptorSetLayout* GetVKDescriptorSetLayout() const { return &mVulkanDescriptorLayout; }
 	};
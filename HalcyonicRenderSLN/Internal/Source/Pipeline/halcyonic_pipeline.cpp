@@ -11,12 +11,6 @@ using namespace hal;
 
 void Pipeline::LoadShader(VkPipelineShaderStageCreateInfo& shaderStage, std::string filename, VkShaderStageFlagBits stage) //Fix/Remove this is gross
 {
-	shaderStage = {};
-
-	shaderStage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-	shaderStage.stage = stage;
-
-	//Create Module
 	size_t size;
 	char* shaderCode;
 
@@ -45,15 +39,25 @@ void Pipeline::LoadShader(VkPipelineShaderStageCreateInfo& shaderStage, std::str
 	AAsset_close(asset);
 #endif
 
+	CreateShaderModule(shaderStage, shaderCode, size, stage);
+	delete[] shaderCode;
+}
+
+void Pipeline::CreateShaderModule(VkPipelineShaderStageCreateInfo& shaderStage, const char* shaderCode, size_t size, VkShaderStageFlagBits stage)
+{
+	shaderStage = {};
+
+	shaderStage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+	shaderStage.stage = stage;
+
 	VkShaderModuleCreateInfo moduleCreateInfo = {};
 	moduleCreateInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
 	moduleCreateInfo.pNext = nullptr;
 	moduleCreateInfo.codeSize = size;
-	moduleCreateInfo.pCode = reinterpret_cast<uint32_t*>(shaderCode);
+	moduleCreateInfo.pCode = reinterpret_cast<const uint32_t*>(shaderCode);
 	moduleCreateInfo.flags = 0;
 
 	HALCYONIC_VK_CHECK(vkCreateShaderModule(hal::Render::Instance()->GetVulkanDevice().GetLogicalDevice(), &moduleCreateInfo, nullptr, &shaderStage.module),"Pipeline: Failed to create shader module.");
-	delete[] shaderCode;
 	HALCYONIC_DEBUG(shaderStage.module != VK_NULL_HANDLE, "Pipeline: Shader module is null");
 
 	shaderStage.pName = "main"; //add ability to change
@@ -85,5 +89,16 @@ Pipeline::Pipeline(PipelineLayout* pipelineLayout) : mPipelineLayout(pipelineLay
 		LoadShader(pipelineLayout->mShaderStageCIs[i], pipelineLayout->mShaderPaths[i]->mPath, static_cast<VkShaderStageFlagBits>(pipelineLayout->mShaderPaths[i]->mStage));
 	}
 	
+	BuildPipelines();
+}
+
+Pipeline::Pipeline(PipelineLayout* pipelineLayout, const std::vector<std::vector<char>>& shaderCode) : mPipelineLayout(pipelineLayout)
+{
+	HALCYONIC_DEBUG((shaderCode.size() == pipelineLayout->mShaderPaths.size()), "Pipeline: Need exactly one shader per stage in the layout");
+	for (uint32_t i = 0; i < static_cast<uint32_t>(pipelineLayout->mShaderPaths.size()); ++i)
+	{
+		CreateShaderModule(pipelineLayout->mShaderStageCIs[i], shaderCode[i].data(), shaderCode[i].size(), static_cast<VkShaderStageFlagBits>(pipelineLayout->mShaderPaths[i]->mStage));
+	}
+
 	BuildPipelines();
 }
\ No newline at end of file
@@ -15,9 +15,13 @@ namespace hal
 		//VkDescriptorSetLayout mVulkanDescriptorLayout;
 
 		static void LoadShader(VkPipelineShaderStageCreateInfo& shaderStage, std::string filename, VkShaderStageFlagBits stage);
+		static void CreateShaderModule(VkPipelineShaderStageCreateInfo& shaderStage, const char* shaderCode, size_t size, VkShaderStageFlagBits stage);
 		void BuildPipelines();
 	public:
 		Pipeline(PipelineLayout* pipelineLayout);
+		//!Builds from SPIR-V already in memory, one entry per shader in the layout and in the same order. Lets the files be
+		//!read on another thread so only the Vulkan calls happen here.
+		Pipeline(PipelineLayout* pipelineLayout, const std::vector<std::vector<char>>& shaderCode);
 
 		const PipelineLayout& GetPipelineLayout() const { return *mPipelineLayout; }
 
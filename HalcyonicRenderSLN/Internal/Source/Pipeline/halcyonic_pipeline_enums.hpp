@@ -20,6 +20,7 @@ namespace hal
 	enum class LayoutBindingDescriptor
 	{
 		UniformBuffer = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,			//!<Uniform Buffer
+		DynamicUniformBuffer = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,	//!<Uniform Buffer read at an offset given when the set is bound
 		ImageSampler = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER	//!<Image Sampler
 	};
 }
\ No newline at end of file
@@ -10,6 +10,7 @@ namespace hal
 	class RenderLayout;
 	class FrameBuffer;
 	class VulkanSwapChain;
+	class CommandPool;
 
 	class Render;
 	typedef std::unique_ptr<Render> render_ptr;
@@ -33,23 +34,58 @@ namespace hal
 		VkSurfaceKHR mSurface;
 		VkQueue mVulkanQueue;
 		VkRenderPassBeginInfo mRenderPassBeginInfo = {};
+		VkCommandBufferInheritanceInfo mInheritanceInfo = {}; //What secondary buffers continue, the frame render pass on the acquired image
+		VkCommandBufferInheritanceInfo mCachedInheritanceInfo = {}; //Same pass with no framebuffer, so a buffer can run on any image
 		VkRect2D mDynamicScissorState = {};
 		VkViewport mVulkanViewport = {};
 
 		VmaAllocator mAllocator;
 
-		VkSemaphore mRenderCompleted;
-		VkSemaphore mPresentCompleted;
+		//Secondary buffers one recording thread has handed out from its pool. The pool is reset and they are handed out again
+		//from the front every time the frame comes round, so a thread only allocates when it records more than it ever has before.
+		struct RecordingThread
+		{
+			CommandPool* mCommandPool;
+			std::vector<DrawBuffer*> vDrawBuffers;
+			uint32_t mUsedDrawBuffers = 0;
+		};
+
+		//Everything one frame in flight records into and waits on. A frame's set is only reused once its fence says the
+		//GPU is done with the last frame that had it.
+		struct FrameResources
+		{
+			VkSemaphore mImageAcquired;
+			VkSemaphore mRenderCompleted;
+			VkFence mFence;
+			CommandPool* mCommandPool;
+			DrawBuffer* mDrawBuffer; //The frame's own command buffer, everything recorded between Begin/EndFrameRenderPass
+			std::vector<RecordingThread> vRecordingThreads;
+		};
+		std::vector<FrameResources> vFrames;
 		
 		bool isRunning = false;
+		bool isFrameBegun = false;
+		bool isFrameRecorded = false;
 
-		uint32_t mCurrentFrame = 0;
+		uint32_t mCurrentFrame = 0; //Frame in flight, indexes vFrames
+		uint32_t mCurrentImage = 0; //Swapchain image acquired by the current frame
+		uint32_t mRecordingThreadCount = 1;
+		uint32_t mSwapchainGeneration = 0;
 
 		std::vector<VkFramebuffer> vFrameBuffers;
-		std::vector<VkFence> vFences;
+		std::vector<VkFence> vImageFences; //Fence of the frame that last rendered to each swapchain image, null until one has
+
+		//Submit scratch, every RenderInfo goes to the queue in one batch
+		std::vector<VkCommandBuffer> vSubmitBuffers;
+		std::vector<VkSemaphore> vSubmitWaitSemaphores;
+		std::vector<VkPipelineStageFlags> vSubmitWaitStages;
+		std::vector<VkSemaphore> vSubmitSignalSemaphores;
+		std::vector<VkCommandBuffer> vExecuteBuffers;
 
 		Render();
-		void SetupDefaultSemaphores();
+		void PrepareRenderPassState();
+		void SetDynamicState(const DrawBuffer& drawBuffer);
+		void SetupFrameResources();
 		void SetupFrameBuffer();
 		void PrepareSychronizationFences();
 		VkResult CreateVulkanInstance();
@@ -65,8 +101,12 @@ namespace hal
 		const RenderLayout& GetRenderLayout() const { return *mRenderLayout; }
 		const VkFormat& GetDepthFormat() const { return mRenderLayout->mVulkanDepthFormat; }
 		const VkFormat& GetColourFormat() const { return mRenderLayout->mVulkanColourFormat; }
-		const VkSemaphore& GetRenderComplete() const { return mRenderCompleted; }
-		const VkSemaphore& GetPresentComplete() const { return mPresentCompleted; }
+		const VkSemaphore& GetRenderComplete() const { return vFrames[mCurrentFrame].mRenderCompleted; }
+		const VkSemaphore& GetPresentComplete() const { return vFrames[mCurrentFrame].mImageAcquired; }
+		//!Pool the current frame in flight records from, reset whole by BeginFrame once that frame is off the GPU. Anything
+		//!from it has to be recorded again every frame it is submitted.
+		const CommandPool* GetFrameCommandPool() const { return vFrames[mCurrentFrame].mCommandPool; }
+		const CommandPool* GetFrameCommandPool(uint32_t frame) const { return vFrames[frame].mCommandPool; }
 
 		//Reference Gets
 		VkSurfaceKHR& GetVulkanSurface() { return mSurface; }
@@ -75,14 +115,20 @@ namespace hal
 
 		//Raw Gets
 		uint32_t GetCurrentFrame() { return mCurrentFrame; }
+		uint32_t GetCurrentImageIndex() { return mCurrentImage; }
+		uint32_t GetFramesInFlight() { return mRenderLayout->mFramesInFlight; }
 		uint32_t GetCurrentHeight() { return mRenderLayout->mRenderHeight; }
 		uint32_t GetCurrentWidth() { return mRenderLayout->mRenderWidth; }
+		//!Changes every time the swapchain and its framebuffers are made, anything recorded against an older one must be recorded again
+		uint32_t GetSwapchainGeneration() { return mSwapchainGeneration; }
 		VkImage* GetCurrentImage();
 
 		//Sets
 		void SetRenderInfoSize(uint32_t size) { vRenderInfos.resize(size); }
 		void AddRenderInfo(const RenderInfo* renderInfo) { vRenderInfos.push_back(renderInfo); }
 		void SetRenderLayout(const RenderLayout* renderLayout) { mRenderLayout = renderLayout; }
+		//!How many threads may record secondary buffers at once, each gets a command pool per frame in flight. Call before InitializeRender.
+		void SetRecordingThreadCount(uint32_t threadCount) { mRecordingThreadCount = threadCount; }
 
 #if  defined(_WIN32)
 		void InitializeVulkan(HINSTANCE instance, HWND window);
@@ -92,9 +138,31 @@ namespace hal
 
 		void InitializeRender(RenderPass* renderPass, DepthStencil* swapchainDepthStencil); //<--change to list and set swapchain to use user created images. Also move command pool to layout
 
+		//!Waits until the GPU is done with this frame in flight's resources, resets its command pools and acquires the swapchain image to draw to.
+		//!Call once per frame before recording anything from GetFrameCommandPool or beginning a render pass.
+		void BeginFrame();
 		void BeginRenderPass(const DrawBuffer& drawBuffer); // Use renderinfo instead
 		void EndRenderPass(const DrawBuffer& drawBuffer);
+		//!Starts the frame's own command buffer and begins one render pass on the acquired image, viewport and scissor set.
+		//!Record every draw of the frame into the returned buffer, then call EndFrameRenderPass. Submit runs it ahead of
+		//!any RenderInfos. With VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS the pass can only take ExecuteDrawBuffers.
+		DrawBuffer& BeginFrameRenderPass(VkSubpassContents contents = VK_SUBPASS_CONTENTS_INLINE);
+		void EndFrameRenderPass();
+		//!Starts a secondary buffer that continues the frame render pass, viewport and scissor set, from recordingThread's
+		//!pool for this frame. Any thread may call it between BeginFrame and Submit as long as no two use the same
+		//!recordingThread at once. End it with EndDrawBuffer and hand it to ExecuteDrawBuffers.
+		DrawBuffer& BeginSecondaryDrawBuffer(uint32_t recordingThread);
+		//!Starts drawBuffer, a secondary buffer the caller owns, so it continues the frame render pass on any swapchain image with
+		//!viewport and scissor set. Once ended it can be passed to ExecuteDrawBuffers every frame until the pipelines, buffers
+		//!or descriptor sets it uses change, or GetSwapchainGeneration does. Only re-record it once no frame in flight uses it.
+		//!It has to come from a CommandPool with the default flags, the frame pools are reset under it every frame.
+		void BeginCachedDrawBuffer(DrawBuffer& drawBuffer);
+		//!Runs secondary buffers inside the frame render pass in the order given
+		void ExecuteDrawBuffers(const std::vector<const DrawBuffer*>& drawBuffers);
+		//!Submits every RenderInfo in one batch, presents, and moves on to the next frame in flight without waiting on the GPU
 		void Submit();
+		//!Blocks until the GPU has finished everything submitted so far. Call before destroying resources a frame in flight may still use.
+		void WaitIdle();
 		
 		~Render();
 	};
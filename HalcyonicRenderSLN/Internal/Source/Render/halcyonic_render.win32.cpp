@@ -8,6 +8,7 @@
 #include <Render/halcyonic_framebuffer_layout.hpp>
 #include <Render/halcyonic_render_layout.hpp>
 #include <Render/halcyonic_render_info.hpp>
+#include <Render/halcyonic_semaphore.hpp>
 #include <Render/halcyonic_render.hpp>
 
 #include <array>
@@ -40,14 +41,16 @@ void hal::Render::SetupFrameBuffer()
 
 void hal::Render::PrepareSychronizationFences()
 {
+	//Created signaled so the first wait on each frame in flight goes straight through
 	VkFenceCreateInfo fenceCreateInfo = {};
 	fenceCreateInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
 	fenceCreateInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
-	vFences.resize(mSwapChain->GetImageCount());
-	for (auto& fence : vFences)
+	for (auto& frame : vFrames)
 	{
-		HALCYONIC_VK_CHECK(vkCreateFence(mVulkanDevice->GetLogicalDevice(), &fenceCreateInfo, nullptr, &fence), "Render: Create fence failed");
+		const VkResult result = vkCreateFence(mVulkanDevice->GetLogicalDevice(), &fenceCreateInfo, nullptr, &frame.mFence);
+		HALCYONIC_VK_CHECK(result, "Render: Create fence failed");
 	}
+	vImageFences.assign(mSwapChain->GetImageCount(), VK_NULL_HANDLE);
 }
 
 VkResult hal::Render::CreateVulkanInstance()
@@ -81,15 +84,32 @@ VkResult hal::Render::CreateVulkanInstance()
 	return vkCreateInstance(&instanceCreateInfo, nullptr, &mVulkanInstance);
 }
 
-void hal::Render::SetupDefaultSemaphores()
+void hal::Render::SetupFrameResources()
 {
+	HALCYONIC_DEBUG((mRenderLayout->mFramesInFlight > 0), "Render: Need at least one frame in flight");
+
 	VkSemaphoreCreateInfo semaphoreCreateInfo;
 	semaphoreCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
 	semaphoreCreateInfo.pNext = nullptr;
 	semaphoreCreateInfo.flags = 0;
-	
-	HALCYONIC_VK_CHECK(vkCreateSemaphore(mVulkanDevice->mLogicalDevice, &semaphoreCreateInfo, nullptr, &mRenderCompleted), "Render: Could not create default semaphore");
-	HALCYONIC_VK_CHECK(vkCreateSemaphore(mVulkanDevice->mLogicalDevice, &semaphoreCreateInfo, nullptr, &mPresentCompleted), "Render: Could not create default semaphore");
+
+	vFrames.resize(mRenderLayout->mFramesInFlight);
+	for (auto& frame : vFrames)
+	{
+		VkResult result = vkCreateSemaphore(mVulkanDevice->mLogicalDevice, &semaphoreCreateInfo, nullptr, &frame.mImageAcquired);
+		HALCYONIC_VK_CHECK(result, "Render: Could not create frame semaphore");
+		result = vkCreateSemaphore(mVulkanDevice->mLogicalDevice, &semaphoreCreateInfo, nullptr, &frame.mRenderCompleted);
+		HALCYONIC_VK_CHECK(result, "Render: Could not create frame semaphore");
+		//Transient pools, reset whole in BeginFrame rather than a buffer at a time
+		frame.mCommandPool = new CommandPool(mSwapChain->GetQueueFamilyIndex(), VK_COMMAND_POOL_CREATE_TRANSIENT_BIT);
+		frame.mDrawBuffer = new DrawBuffer(frame.mCommandPool, {});
+
+		frame.vRecordingThreads.resize(mRecordingThreadCount);
+		for (auto& recordingThread : frame.vRecordingThreads)
+		{
+			recordingThread.mCommandPool = new CommandPool(mSwapChain->GetQueueFamilyIndex(), VK_COMMAND_POOL_CREATE_TRANSIENT_BIT);
+		}
+	}
 }
 
 void hal::Render::CreateInstance()
@@ -150,14 +170,12 @@ void hal::Render::InitializeVulkan(HINSTANCE instance, HWND window)
 
 	HALCYONIC_VK_CHECK(vmaCreateAllocator(&allocatorInfo, &mAllocator), "Render: Could not create a memory allocator");
 
-	SetupDefaultSemaphores();
-
 	mSwapChain->InitializeSurface(instance, window);
 }
 
 VkImage * hal::Render::GetCurrentImage()
 {
-	return &mSwapChain->GetSwapChainBuffer(mCurrentFrame)->image;
+	return &mSwapChain->GetSwapChainBuffer(mCurrentImage)->image;
 }
 
 void hal::Render::InitializeRender(RenderPass* renderPass, DepthStencil* swapchainDepthStencil)
@@ -171,16 +189,51 @@ void hal::Render::InitializeRender(RenderPass* renderPass, DepthStencil* swapcha
 	//Setupt the frame buffer
 	SetupFrameBuffer();
 
+	SetupFrameResources();
 	PrepareSychronizationFences();
+	PrepareRenderPassState();
+	++mSwapchainGeneration;
 
 	isRunning = true;
 }
 
-void hal::Render::BeginRenderPass(const DrawBuffer& drawBuffer)
+void hal::Render::BeginFrame()
 {
-	HALCYONIC_VK_CHECK(mSwapChain->GetNextImage(mPresentCompleted, &mCurrentFrame), "Render: Could not get next swapchain image");
+	FrameResources& frame = vFrames[mCurrentFrame];
+
+	//Only blocks if the CPU has got a full set of frames ahead of the GPU
+	VkResult result = vkWaitForFences(mVulkanDevice->GetLogicalDevice(), 1, &frame.mFence, VK_TRUE, UINT64_MAX);
+	HALCYONIC_VK_CHECK(result, "Render: Wait for frame fence failed");
+
+	result = mSwapChain->GetNextImage(frame.mImageAcquired, &mCurrentImage);
+	HALCYONIC_VK_CHECK(result, "Render: Could not get next swapchain image");
+
+	//Images can come back in any order, so the one just acquired may still be drawn to by another frame in flight
+	const VkFence imageFence = vImageFences[mCurrentImage];
+	if (imageFence != VK_NULL_HANDLE && imageFence != frame.mFence)
+	{
+		result = vkWaitForFences(mVulkanDevice->GetLogicalDevice(), 1, &imageFence, VK_TRUE, UINT64_MAX);
+		HALCYONIC_VK_CHECK(result, "Render: Wait for image fence failed");
+	}
+	vImageFences[mCurrentImage] = frame.mFence;
+
+	//The GPU is done with everything this frame recorded last time round, so its pools are reset in one go and their
+	//buffers handed out again from the front
+	frame.mCommandPool->Reset();
+	for (auto& recordingThread : frame.vRecordingThreads)
+	{
+		recordingThread.mCommandPool->Reset();
+		recordingThread.mUsedDrawBuffers = 0;
+	}
+
+	mRenderPassBeginInfo.framebuffer = vFrameBuffers[mCurrentImage];
+	mInheritanceInfo.framebuffer = vFrameBuffers[mCurrentImage];
+	isFrameBegun = true;
+}
 
-	mRenderPassBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO; //move to happen once
+void hal::Render::PrepareRenderPassState()
+{
+	mRenderPassBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
 	mRenderPassBeginInfo.pNext = nullptr;
 	mRenderPassBeginInfo.renderPass = mRenderPass->GetVulkanRenderPass();
 	mRenderPassBeginInfo.renderArea.offset.x = 0;
@@ -189,55 +242,171 @@ void hal::Render::BeginRenderPass(const DrawBuffer& drawBuffer)
 	mRenderPassBeginInfo.renderArea.extent.height = mRenderLayout->mRenderHeight;
 	mRenderPassBeginInfo.clearValueCount = 2;
 	mRenderPassBeginInfo.pClearValues = mRenderLayout->vClearValues.data();
-	mRenderPassBeginInfo.framebuffer = vFrameBuffers[mCurrentFrame];
+	mRenderPassBeginInfo.framebuffer = VK_NULL_HANDLE; //Set to the acquired image in BeginFrame
 
-	vkCmdBeginRenderPass(drawBuffer.GetCommandBuffer(), &mRenderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+	mCachedInheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+	mCachedInheritanceInfo.pNext = nullptr;
+	mCachedInheritanceInfo.renderPass = mRenderPass->GetVulkanRenderPass();
+	mCachedInheritanceInfo.subpass = 0;
+	mCachedInheritanceInfo.framebuffer = VK_NULL_HANDLE;
+
+	mInheritanceInfo = mCachedInheritanceInfo;
 
 	mVulkanViewport.width = (float)mRenderLayout->mRenderWidth;
 	mVulkanViewport.height = (float)mRenderLayout->mRenderHeight;
 	mVulkanViewport.minDepth = 0.0f;
 	mVulkanViewport.maxDepth = 1.0f;
 
-	vkCmdSetViewport(drawBuffer.GetCommandBuffer(), 0, 1, &mVulkanViewport);
-
 	mDynamicScissorState.extent.width = mRenderLayout->mRenderWidth;
 	mDynamicScissorState.extent.height = mRenderLayout->mRenderHeight;
 	mDynamicScissorState.offset.x = 0;
 	mDynamicScissorState.offset.y = 0;
+}
 
+void hal::Render::SetDynamicState(const DrawBuffer& drawBuffer)
+{
+	vkCmdSetViewport(drawBuffer.GetCommandBuffer(), 0, 1, &mVulkanViewport);
 	vkCmdSetScissor(drawBuffer.GetCommandBuffer(), 0, 1, &mDynamicScissorState);
 }
 
+void hal::Render::BeginRenderPass(const DrawBuffer& drawBuffer)
+{
+	HALCYONIC_DEBUG((isFrameBegun), "Render: Call BeginFrame before beginning a render pass");
+
+	vkCmdBeginRenderPass(drawBuffer.GetCommandBuffer(), &mRenderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+	SetDynamicState(drawBuffer);
+}
+
 void hal::Render::EndRenderPass(const DrawBuffer& drawBuffer)
 {
 	vkCmdEndRenderPass(drawBuffer.GetCommandBuffer());
 }
 
+DrawBuffer& hal::Render::BeginFrameRenderPass(VkSubpassContents contents)
+{
+	HALCYONIC_DEBUG((isFrameBegun), "Render: Call BeginFrame before beginning a render pass");
+
+	DrawBuffer& drawBuffer = *vFrames[mCurrentFrame].mDrawBuffer;
+	drawBuffer.StartDrawBuffer();
+	vkCmdBeginRenderPass(drawBuffer.GetCommandBuffer(), &mRenderPassBeginInfo, contents);
+	//Secondary buffers set their own, dynamic state isn't inherited
+	if (contents == VK_SUBPASS_CONTENTS_INLINE)
+	{
+		SetDynamicState(drawBuffer);
+	}
+	return drawBuffer;
+}
+
+void hal::Render::EndFrameRenderPass()
+{
+	DrawBuffer& drawBuffer = *vFrames[mCurrentFrame].mDrawBuffer;
+	EndRenderPass(drawBuffer);
+	drawBuffer.EndDrawBuffer();
+	isFrameRecorded = true;
+}
+
+DrawBuffer& hal::Render::BeginSecondaryDrawBuffer(uint32_t recordingThread)
+{
+	HALCYONIC_DEBUG((isFrameBegun), "Render: Call BeginFrame before recording secondary buffers");
+	HALCYONIC_DEBUG((recordingThread < mRecordingThreadCount), "Render: Recording thread out of range, see SetRecordingThreadCount");
+
+	RecordingThread& thread = vFrames[mCurrentFrame].vRecordingThreads[recordingThread];
+	if (thread.mUsedDrawBuffers == thread.vDrawBuffers.size())
+	{
+		thread.vDrawBuffers.push_back(new DrawBuffer(thread.mCommandPool, {}, VK_COMMAND_BUFFER_LEVEL_SECONDARY));
+	}
+	DrawBuffer& drawBuffer = *thread.vDrawBuffers[thread.mUsedDrawBuffers++];
+
+	drawBuffer.StartDrawBuffer(mInheritanceInfo);
+	SetDynamicState(drawBuffer);
+	return drawBuffer;
+}
+
+void hal::Render::BeginCachedDrawBuffer(DrawBuffer& drawBuffer)
+{
+	HALCYONIC_DEBUG((isRunning), "Render: Call InitializeRender before recording cached buffers");
+
+	drawBuffer.StartDrawBuffer(mCachedInheritanceInfo, 0);
+	SetDynamicState(drawBuffer);
+}
+
+void hal::Render::ExecuteDrawBuffers(const std::vector<const DrawBuffer*>& drawBuffers)
+{
+	vExecuteBuffers.resize(drawBuffers.size());
+	for (size_t i = 0; i < drawBuffers.size(); ++i)
+	{
+		vExecuteBuffers[i] = drawBuffers[i]->GetCommandBuffer();
+	}
+	vkCmdExecuteCommands(vFrames[mCurrentFrame].mDrawBuffer->GetCommandBuffer(), static_cast<uint32_t>(vExecuteBuffers.size()), vExecuteBuffers.data());
+}
+
 void hal::Render::Submit()
 {
 	if (isRunning)
 	{
-		// Use a fence to wait until the command buffer has finished execution before using it again
-		HALCYONIC_VK_CHECK(vkWaitForFences(mVulkanDevice->GetLogicalDevice(), 1, &vFences[mCurrentFrame], VK_TRUE, UINT64_MAX), "Render: Wait For Fences in Render");
-		HALCYONIC_VK_CHECK(vkResetFences(mVulkanDevice->GetLogicalDevice(), 1, &vFences[mCurrentFrame]), "Render: Reset Fences in Render");
+		HALCYONIC_DEBUG((isFrameBegun), "Render: Call BeginFrame before Submit");
+		HALCYONIC_DEBUG((isFrameRecorded || vRenderInfos.size() > 0), "Render: Nothing recorded or set to draw");
 
-		// Pipeline stage at which the queue submission will wait
-		
-		HALCYONIC_DEBUG((vRenderInfos.size() > 0), "Render: No RenderInfos set to draw");
-		
-		for (auto& renderInfo : vRenderInfos)
+		FrameResources& frame = vFrames[mCurrentFrame];
+
+		// The frame's buffer and every RenderInfo go in one submit, waiting on the acquired image and signalling the frame's render semaphore
+		vSubmitBuffers.clear();
+		if (isFrameRecorded)
+		{
+			vSubmitBuffers.push_back(frame.mDrawBuffer->GetCommandBuffer());
+		}
+		vSubmitWaitSemaphores.assign(1, frame.mImageAcquired);
+		vSubmitSignalSemaphores.assign(1, frame.mRenderCompleted);
+		for (const RenderInfo* renderInfo : vRenderInfos)
 		{
-			HALCYONIC_VK_CHECK(vkQueueSubmit(mVulkanQueue, 1, &renderInfo->GetSubmitInfo(), vFences[mCurrentFrame]), "Render: Queue Submit failed");
-			HALCYONIC_VK_CHECK(vkQueueWaitIdle(mVulkanQueue), "Render: Queue Wait Idle failed");
+			const auto& commandBuffers = renderInfo->GetCommandBuffers();
+			vSubmitBuffers.insert(vSubmitBuffers.end(), commandBuffers.begin(), commandBuffers.end());
+
+			const Semaphore* semaphore = renderInfo->GetSemaphore();
+			if (semaphore != nullptr)
+			{
+				vSubmitWaitSemaphores.insert(vSubmitWaitSemaphores.end(), semaphore->GetWaitSemaphores().begin(), semaphore->GetWaitSemaphores().end());
+				vSubmitSignalSemaphores.insert(vSubmitSignalSemaphores.end(), semaphore->GetSignalSemaphores().begin(), semaphore->GetSignalSemaphores().end());
+			}
 		}
+		// Pipeline stage at which the queue submission will wait
+		vSubmitWaitStages.assign(vSubmitWaitSemaphores.size(), mSubmitPipelineStages);
+
+		VkSubmitInfo submitInfo = {};
+		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		submitInfo.waitSemaphoreCount = static_cast<uint32_t>(vSubmitWaitSemaphores.size());
+		submitInfo.pWaitSemaphores = vSubmitWaitSemaphores.data();
+		submitInfo.pWaitDstStageMask = vSubmitWaitStages.data();
+		submitInfo.commandBufferCount = static_cast<uint32_t>(vSubmitBuffers.size());
+		submitInfo.pCommandBuffers = vSubmitBuffers.data();
+		submitInfo.signalSemaphoreCount = static_cast<uint32_t>(vSubmitSignalSemaphores.size());
+		submitInfo.pSignalSemaphores = vSubmitSignalSemaphores.data();
+
+		// Reset as late as possible, a frame that fails before here leaves its fence signaled for the next wait
+		VkResult result = vkResetFences(mVulkanDevice->GetLogicalDevice(), 1, &frame.mFence);
+		HALCYONIC_VK_CHECK(result, "Render: Reset Fences in Render");
+		result = vkQueueSubmit(mVulkanQueue, 1, &submitInfo, frame.mFence);
+		HALCYONIC_VK_CHECK(result, "Render: Queue Submit failed");
 		
 		// Present the current buffer to the swap chain
 		// Pass the semaphore signaled by the command buffer submission from the submit info as the wait semaphore for swap chain presentation
 		// This ensures that the image is not presented to the windowing system until all commands have been submitted
-		HALCYONIC_VK_CHECK(mSwapChain->QueuePresentation(mCurrentFrame, mRenderCompleted),"Render: Queue Presentation Failed.");
+		result = mSwapChain->QueuePresentation(mCurrentImage, frame.mRenderCompleted);
+		HALCYONIC_VK_CHECK(result, "Render: Queue Presentation Failed.");
+
+		// The GPU is left to it, the fence is only waited on when this frame's resources come round again
+		mCurrentFrame = (mCurrentFrame + 1) % static_cast<uint32_t>(vFrames.size());
+		isFrameBegun = false;
+		isFrameRecorded = false;
 	}
 }
 
+void hal::Render::WaitIdle()
+{
+	VkResult result = vkQueueWaitIdle(mVulkanQueue);
+	HALCYONIC_VK_CHECK(result, "Render: Queue Wait Idle failed");
+}
+
 hal::Render::~Render()
 {
 	s_Instance.release();
@@ -39,20 +39,20 @@ void hal::RenderInfo::BuildRenderinfo()
 {
 	HALCYONIC_DEBUG((vDrawCommandBuffers.size() > 0), "RenderInfo: Draw Buffers are empty");
 
-	if(vRawDrawBuffers.size() < vDrawCommandBuffers.size())
+	vRawDrawBuffers.resize(vDrawCommandBuffers.size());
+	for (uint32_t i = 0; i < vDrawCommandBuffers.size(); ++i)
 	{
-		vRawDrawBuffers.reserve(vDrawCommandBuffers.size());
-		for (uint32_t i = static_cast<uint32_t>(vRawDrawBuffers.size()); i < vDrawCommandBuffers.size(); ++i)
-		{
-			vRawDrawBuffers.push_back(vDrawCommandBuffers[i]->GetCommandBuffer());
-		}
+		vRawDrawBuffers[i] = vDrawCommandBuffers[i]->GetCommandBuffer();
 	}
-	else if(vRawDrawBuffers.size() == vDrawCommandBuffers.size())
+}
+
+void hal::RenderInfo::BuildRenderinfo(const std::vector<uint32_t>& drawBufferIndices)
+{
+	vRawDrawBuffers.resize(drawBufferIndices.size());
+	for (uint32_t i = 0; i < drawBufferIndices.size(); ++i)
 	{
-		for (uint32_t i = static_cast<uint32_t>(vDrawCommandBuffers.size()); i < vDrawCommandBuffers.size(); ++i)
-		{
-			vRawDrawBuffers[i] = vDrawCommandBuffers[i]->GetCommandBuffer();
-		}
+		HALCYONIC_DEBUG((drawBufferIndices[i] < vDrawCommandBuffers.size()), "RenderInfo: Draw buffer index out of range");
+		vRawDrawBuffers[i] = vDrawCommandBuffers[drawBufferIndices[i]]->GetCommandBuffer();
 	}
 }
 
@@ -23,8 +23,12 @@ namespace hal
 		const DrawBuffer* GetDrawBuffer(uint32_t index) const;
 		const std::vector<DrawBuffer*>& GetDrawBufferList() const { return vDrawCommandBuffers; }
 		const VkSubmitInfo& GetSubmitInfo() const;
+		//!Command buffers picked by the last BuildRenderinfo, what Render::Submit batches
+		const std::vector<VkCommandBuffer>& GetCommandBuffers() const { return vRawDrawBuffers; }
+		const Semaphore* GetSemaphore() const { return mSemaphore; }
 
-		void BuildRenderinfo();
+		void BuildRenderinfo(); //Draw buffers have a command buffer per frame in flight, rebuild every frame after Render::BeginFrame
+		void BuildRenderinfo(const std::vector<uint32_t>& drawBufferIndices); //Only the listed draw buffers get submitted, same as above
 		void BuildSubmitinfo(); //Clean up maybe move to Get
 		~RenderInfo() = default;
 	};
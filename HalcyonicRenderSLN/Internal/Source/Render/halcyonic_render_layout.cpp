@@ -6,12 +6,13 @@
 
 using namespace hal;
 
-hal::RenderLayout::RenderLayout(VkFormat colourFormat, VkFormat depthFormat, std::vector<VkClearValue> clearValues, uint32_t renderWidth, uint32_t renderHeight, bool enableVSync, bool enableValidation):
+hal::RenderLayout::RenderLayout(VkFormat colourFormat, VkFormat depthFormat, std::vector<VkClearValue> clearValues, uint32_t renderWidth, uint32_t renderHeight, bool enableVSync, bool enableValidation, uint32_t framesInFlight):
 	mVulkanColourFormat(colourFormat),
 	mVulkanDepthFormat(depthFormat),
 	vClearValues(std::move(clearValues)),
 	mRenderWidth(renderWidth),
 	mRenderHeight(renderHeight),
+	mFramesInFlight(framesInFlight),
 	mEnableVSync(enableVSync),
 	mEnableValidation(enableValidation),
 	mSwapchainFramebufferLayout(new FramebufferLayout(renderWidth, renderHeight))
@@ -0,0 +1,175 @@
+#include "precompiled.hpp"
+#include "MathSIMD.hpp"
+#include "Vector3.hpp"
+#include "Matrix4.hpp"
+#include "Quaternion.hpp"
+#include "AffineTransform.hpp"
+
+#include <algorithm>
+
+AffineTransform AffineTransform::FromTRS(const Vector3& translation, const Quaternion& rotation, const Vector3& scale)
+{
+	const float x = rotation.x;
+	const float y = rotation.y;
+	const float z = rotation.z;
+	const float w = rotation.w;
+	const float xx = 2.0f * x * x;
+	const float yy = 2.0f * y * y;
+	const float zz = 2.0f * z * z;
+	const float xy = 2.0f * x * y;
+	const float xz = 2.0f * x * z;
+	const float yz = 2.0f * y * z;
+	const float xw = 2.0f * x * w;
+	const float yw = 2.0f * y * w;
+	const float zw = 2.0f * z * w;
+
+	return AffineTransform
+	(
+		(1.0f - yy - zz) * scale.x, (xy - zw) * scale.y, (xz + yw) * scale.z, translation.x,
+		(xy + zw) * scale.x, (1.0f - xx - zz) * scale.y, (yz - xw) * scale.z, translation.y,
+		(xz - yw) * scale.x, (yz + xw) * scale.y, (1.0f - xx - yy) * scale.z, translation.z
+	);
+}
+
+AffineTransform AffineTransform::FromMatrix4(const Matrix4& matrix)
+{
+	return AffineTransform
+	(
+		matrix.m11, matrix.m21, matrix.m31, matrix.m41,
+		matrix.m12, matrix.m22, matrix.m32, matrix.m42,
+		matrix.m13, matrix.m23, matrix.m33, matrix.m43
+	);
+}
+
+AffineTransform AffineTransform::Lerp(const AffineTransform& a, const AffineTransform& b, float t)
+{
+	AffineTransform result;
+	for (uint32_t row = 0; row < 3; ++row)
+	{
+		for (uint32_t column = 0; column < 4; ++column)
+		{
+			result.rows[row][column] = a.rows[row][column] + ((b.rows[row][column] - a.rows[row][column]) * t);
+		}
+	}
+	return result;
+}
+
+float AffineTransform::Determinant() const
+{
+	return rows[0][0] * ((rows[1][1] * rows[2][2]) - (rows[1][2] * rows[2][1])) -
+		rows[0][1] * ((rows[1][0] * rows[2][2]) - (rows[1][2] * rows[2][0])) +
+		rows[0][2] * ((rows[1][0] * rows[2][1]) - (rows[1][1] * rows[2][0]));
+}
+
+float AffineTransform::GetMaxScale() const
+{
+	float longest = 0.0f;
+	for (uint32_t column = 0; column < 3; ++column)
+	{
+		const float lengthSquared = (rows[0][column] * rows[0][column]) + (rows[1][column] * rows[1][column]) + (rows[2][column] * rows[2][column]);
+		longest = (std::max)(longest, lengthSquared);
+	}
+	return sqrt(longest);
+}
+
+AffineTransform AffineTransform::InverseRigid() const
+{
+	const float tx = rows[0][3];
+	const float ty = rows[1][3];
+	const float tz = rows[2][3];
+	return AffineTransform
+	(
+		rows[0][0], rows[1][0], rows[2][0], -((rows[0][0] * tx) + (rows[1][0] * ty) + (rows[2][0] * tz)),
+		rows[0][1], rows[1][1], rows[2][1], -((rows[0][1] * tx) + (rows[1][1] * ty) + (rows[2][1] * tz)),
+		rows[0][2], rows[1][2], rows[2][2], -((rows[0][2] * tx) + (rows[1][2] * ty) + (rows[2][2] * tz))
+	);
+}
+
+AffineTransform AffineTransform::Inverse() const
+{
+	const float determinant = Determinant();
+	assert(determinant != 0.0f);
+	const float dec = 1.0f / determinant;
+
+	const float i00 = ((rows[1][1] * rows[2][2]) - (rows[1][2] * rows[2][1])) * dec;
+	const float i01 = ((rows[0][2] * rows[2][1]) - (rows[0][1] * rows[2][2])) * dec;
+	const float i02 = ((rows[0][1] * rows[1][2]) - (rows[0][2] * rows[1][1])) * dec;
+	const float i10 = ((rows[1][2] * rows[2][0]) - (rows[1][0] * rows[2][2])) * dec;
+	const float i11 = ((rows[0][0] * rows[2][2]) - (rows[0][2] * rows[2][0])) * dec;
+	const float i12 = ((rows[0][2] * rows[1][0]) - (rows[0][0] * rows[1][2])) * dec;
+	const float i20 = ((rows[1][0] * rows[2][1]) - (rows[1][1] * rows[2][0])) * dec;
+	const float i21 = ((rows[0][1] * rows[2][0]) - (rows[0][0] * rows[2][1])) * dec;
+	const float i22 = ((rows[0][0] * rows[1][1]) - (rows[0][1] * rows[1][0])) * dec;
+
+	const float tx = rows[0][3];
+	const float ty = rows[1][3];
+	const float tz = rows[2][3];
+	return AffineTransform
+	(
+		i00, i01, i02, -((i00 * tx) + (i01 * ty) + (i02 * tz)),
+		i10, i11, i12, -((i10 * tx) + (i11 * ty) + (i12 * tz)),
+		i20, i21, i22, -((i20 * tx) + (i21 * ty) + (i22 * tz))
+	);
+}
+
+Vector3 AffineTransform::TransformPoint(const Vector3& point) const
+{
+	return Vector3
+	(
+		(rows[0][0] * point.x) + (rows[0][1] * point.y) + (rows[0][2] * point.z) + rows[0][3],
+		(rows[1][0] * point.x) + (rows[1][1] * point.y) + (rows[1][2] * point.z) + rows[1][3],
+		(rows[2][0] * point.x) + (rows[2][1] * point.y) + (rows[2][2] * point.z) + rows[2][3]
+	);
+}
+
+Vector3 AffineTransform::TransformDirection(const Vector3& direction) const
+{
+	return Vector3
+	(
+		(rows[0][0] * direction.x) + (rows[0][1] * direction.y) + (rows[0][2] * direction.z),
+		(rows[1][0] * direction.x) + (rows[1][1] * direction.y) + (rows[1][2] * direction.z),
+		(rows[2][0] * direction.x) + (rows[2][1] * direction.y) + (rows[2][2] * direction.z)
+	);
+}
+
+Matrix4 AffineTransform::ToMatrix4() const
+{
+	return Matrix4
+	(
+		rows[0][0], rows[0][1], rows[0][2], rows[0][3],
+		rows[1][0], rows[1][1], rows[1][2], rows[1][3],
+		rows[2][0], rows[2][1], rows[2][2], rows[2][3],
+		0.0f, 0.0f, 0.0f, 1.0f
+	);
+}
+
+AffineTransform AffineTransform::operator*(const AffineTransform& b) const
+{
+	AffineTransform result;
+#if defined(MATH_SIMD_SSE2)
+	//Each result row is a weighted sum of b's rows, plus this row's translation in w
+	const __m128 b0 = _mm_load_ps(b.rows[0]);
+	const __m128 b1 = _mm_load_ps(b.rows[1]);
+	const __m128 b2 = _mm_load_ps(b.rows[2]);
+	const __m128 wMask = _mm_castsi128_ps(_mm_set_epi32(-1, 0, 0, 0));
+	for (uint32_t i = 0; i < 3; ++i)
+	{
+		const __m128 a = _mm_load_ps(rows[i]);
+		__m128 row = _mm_and_ps(a, wMask);
+		row = _mm_add_ps(row, _mm_mul_ps(MATH_SPLAT(a, 0), b0));
+		row = _mm_add_ps(row, _mm_mul_ps(MATH_SPLAT(a, 1), b1));
+		row = _mm_add_ps(row, _mm_mul_ps(MATH_SPLAT(a, 2), b2));
+		_mm_store_ps(result.rows[i], row);
+	}
+#else
+	for (uint32_t i = 0; i < 3; ++i)
+	{
+		for (uint32_t j = 0; j < 4; ++j)
+		{
+			result.rows[i][j] = (rows[i][0] * b.rows[0][j]) + (rows[i][1] * b.rows[1][j]) + (rows[i][2] * b.rows[2][j]);
+		}
+		result.rows[i][3] += rows[i][3];
+	}
+#endif
+	return result;
+}
\ No newline at end of file
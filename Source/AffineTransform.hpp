@@ -0,0 +1,59 @@
+#pragma once
+#include "Vector3.hpp"
+
+//Row major 3x4, the fourth row is always 0 0 0 1 and never stored. Each row holds the rotation/scale in xyz and the
+//translation in w. The layout matches a std140 layout(row_major) mat4x3, so it can be copied straight into a uniform buffer.
+class Matrix4;
+class Quaternion;
+class alignas(16) AffineTransform
+{
+public:
+	float rows[3][4];
+
+	constexpr AffineTransform() :
+		rows{ { 1.0f, 0.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 1.0f, 0.0f } }
+	{
+	}
+	constexpr AffineTransform(
+		float _11, float _21, float _31, float _41,
+		float _12, float _22, float _32, float _42,
+		float _13, float _23, float _33, float _43) :
+		rows{ { _11, _21, _31, _41 }, { _12, _22, _32, _42 }, { _13, _23, _33, _43 } }
+	{
+	}
+
+	static constexpr AffineTransform Translation(const Vector3& t)
+	{
+		return AffineTransform
+		(
+			1.0f, 0.0f, 0.0f, t.x,
+			0.0f, 1.0f, 0.0f, t.y,
+			0.0f, 0.0f, 1.0f, t.z
+		);
+	}
+	//Translation * rotation * scale
+	static AffineTransform FromTRS(const Vector3& translation, const Quaternion& rotation, const Vector3& scale);
+	//Drops the bottom row, only valid for matrices that are already affine
+	static AffineTransform FromMatrix4(const Matrix4& matrix);
+	//Element by element. Rotations shrink towards the middle, which is invisible over the few degrees between two
+	//simulation steps but not for anything bigger.
+	static AffineTransform Lerp(const AffineTransform& a, const AffineTransform& b, float t);
+
+	constexpr Vector3 GetTranslation() const { return Vector3(rows[0][3], rows[1][3], rows[2][3]); }
+
+	float Determinant() const;
+	//Length of the longest basis vector, what a bounding sphere's radius has to grow by
+	float GetMaxScale() const;
+	//Transpose of the 3x3 plus a rotated translation. Only valid for rotation and translation, no scale or shear.
+	AffineTransform InverseRigid() const;
+	//Full 3x3 inverse through cofactors, handles scale and shear
+	AffineTransform Inverse() const;
+
+	Vector3 TransformPoint(const Vector3& point) const;
+	Vector3 TransformDirection(const Vector3& direction) const;
+
+	Matrix4 ToMatrix4() const;
+
+	//a * b applies b first then a, 36 multiplies against the 64 of Matrix4
+	AffineTransform operator*(const AffineTransform& b) const;
+};
\ No newline at end of file
@@ -0,0 +1,194 @@
+#include "precompiled.hpp"
+#include "BackgroundScheduler.hpp"
+
+background_scheduler_ptr BackgroundScheduler::s_Instance = nullptr;
+
+namespace
+{
+	float MicrosecondsSince(std::chrono::steady_clock::time_point start)
+	{
+		return std::chrono::duration<float, std::micro>(std::chrono::steady_clock::now() - start).count();
+	}
+}
+
+BackgroundScheduler::BackgroundScheduler() :
+	mFrameBudget(2000),
+	mWorkerRunning(false),
+	mShutdown(false)
+{
+	mWorkerJob.mFunction = [](void* data) { static_cast<BackgroundScheduler*>(data)->RunWorker(); };
+	mWorkerJob.mData = this;
+}
+
+void BackgroundScheduler::CreateInstance()
+{
+	if (s_Instance == nullptr)
+	{
+		s_Instance = static_cast<background_scheduler_ptr>(new BackgroundScheduler());
+	}
+}
+
+const background_scheduler_ptr & BackgroundScheduler::Instance()
+{
+	assert(s_Instance != nullptr);
+	return s_Instance;
+}
+
+void BackgroundScheduler::DestroyInstance()
+{
+	s_Instance.reset();
+}
+
+BackgroundScheduler::~BackgroundScheduler()
+{
+	//The worker stops after its current step, unfinished tasks are dropped with the queues
+	mShutdown.store(true, std::memory_order_seq_cst);
+	while (mWorkerRunning.load(std::memory_order_acquire))
+	{
+		std::this_thread::yield();
+	}
+}
+
+void BackgroundScheduler::Submit(BackgroundStep step, BackgroundPriority priority, bool anyThread)
+{
+	BackgroundTask task;
+	task.mStep = std::move(step);
+	PushTask(std::move(task), priority, anyThread, false);
+	if (anyThread)
+	{
+		StartWorker();
+	}
+}
+
+void BackgroundScheduler::PushTask(BackgroundTask&& task, BackgroundPriority priority, bool anyThread, bool front)
+{
+	std::lock_guard<std::mutex> lock(mTaskMutex);
+	std::deque<BackgroundTask>& tasks = anyThread ? mAnyThreadTasks[static_cast<uint32_t>(priority)] : mGameThreadTasks[static_cast<uint32_t>(priority)];
+	if (front)
+	{
+		tasks.push_front(std::move(task));
+	}
+	else
+	{
+		tasks.push_back(std::move(task));
+	}
+}
+
+bool BackgroundScheduler::PopTask(bool gameThread, BackgroundTask& task, BackgroundPriority& priority, bool& anyThread)
+{
+	std::lock_guard<std::mutex> lock(mTaskMutex);
+	for (uint32_t i = 0; i < static_cast<uint32_t>(BackgroundPriority::Count); ++i)
+	{
+		//Game thread tasks go first, the worker can't help with them
+		std::deque<BackgroundTask>* tasks = nullptr;
+		if (gameThread && !mGameThreadTasks[i].empty())
+		{
+			tasks = &mGameThreadTasks[i];
+			anyThread = false;
+		}
+		else if (!mAnyThreadTasks[i].empty())
+		{
+			tasks = &mAnyThreadTasks[i];
+			anyThread = true;
+		}
+		if (tasks != nullptr)
+		{
+			task = std::move(tasks->front());
+			tasks->pop_front();
+			priority = static_cast<BackgroundPriority>(i);
+			return true;
+		}
+	}
+	return false;
+}
+
+bool BackgroundScheduler::HasAnyThreadTasks()
+{
+	std::lock_guard<std::mutex> lock(mTaskMutex);
+	for (const auto& tasks : mAnyThreadTasks)
+	{
+		if (!tasks.empty())
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+bool BackgroundScheduler::RunStep(BackgroundTask& task)
+{
+	const auto start = std::chrono::steady_clock::now();
+	const bool more = task.mStep();
+	const float took = MicrosecondsSince(start);
+	//Recent steps count for more, tasks often change pace as they go
+	task.mAverageStepMicroseconds = task.mAverageStepMicroseconds == 0.0f ? took : (task.mAverageStepMicroseconds * 0.75f) + (took * 0.25f);
+	return more;
+}
+
+uint32_t BackgroundScheduler::RunFrameSlice()
+{
+	const auto start = std::chrono::steady_clock::now();
+	const float budget = static_cast<float>(mFrameBudget.count());
+	uint32_t steps = 0;
+	for (;;)
+	{
+		const float elapsed = MicrosecondsSince(start);
+		BackgroundTask task;
+		BackgroundPriority priority;
+		bool anyThread;
+		if (elapsed >= budget || !PopTask(true, task, priority, anyThread))
+		{
+			break;
+		}
+		//Leave a step that looks like it won't fit for the next frame. The first step always runs, or a task slower than
+		//the whole budget would never get a turn.
+		if (steps != 0 && elapsed + task.mAverageStepMicroseconds > budget)
+		{
+			PushTask(std::move(task), priority, anyThread, true);
+			break;
+		}
+
+		++steps;
+		if (RunStep(task))
+		{
+			PushTask(std::move(task), priority, anyThread, false);
+		}
+	}
+
+	//The worker gives up whenever frame jobs are queued, so give it another go each frame
+	StartWorker();
+	return steps;
+}
+
+void BackgroundScheduler::StartWorker()
+{
+	if (HasAnyThreadTasks() && !mWorkerRunning.exchange(true, std::memory_order_acq_rel))
+	{
+		JobSystem::Instance()->Schedule(mWorkerJob);
+	}
+}
+
+void BackgroundScheduler::RunWorker()
+{
+	//Waiting on frame jobs is the only way the game thread picks up a job, and it mustn't get stuck doing background
+	//work there, so it leaves it all for the frame slice
+	const bool gameThread = JobSystem::GetThreadIndex() == 0;
+	//Frame jobs always come first, the worker only ever stops between steps
+	while (!gameThread && !mShutdown.load(std::memory_order_relaxed) && JobSystem::Instance()->GetQueuedJobCount() == 0)
+	{
+		BackgroundTask task;
+		BackgroundPriority priority;
+		bool anyThread;
+		if (!PopTask(false, task, priority, anyThread))
+		{
+			break;
+		}
+		if (RunStep(task))
+		{
+			PushTask(std::move(task), priority, anyThread, false);
+		}
+	}
+	//Last touch, the destructor may free the scheduler straight after. A task submitted since the last pop saw the worker
+	//running and didn't start another, the next frame slice will.
+	mWorkerRunning.store(false, std::memory_order_release);
+}
\ No newline at end of file
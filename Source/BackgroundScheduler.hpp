@@ -0,0 +1,87 @@
+#pragma once
+#include "JobSystem.hpp"
+#include "Task.hpp"
+
+#include <chrono>
+#include <deque>
+#include <functional>
+
+//Strictly in order, nothing Low runs while there is anything Normal to do
+enum class BackgroundPriority : uint32_t
+{
+	High,
+	Normal,
+	Low,
+	Count
+};
+
+//Returns true to be called again. Each call should be a small slice of the work, it is never interrupted and the
+//scheduler only gets to stop between calls.
+typedef std::function<bool()> BackgroundStep;
+
+class BackgroundScheduler;
+typedef std::unique_ptr<BackgroundScheduler> background_scheduler_ptr;
+//Somewhere for work that doesn't belong to any one frame, asset decompression, cache clean up, stats and the like. The game
+//thread gives it a slice of every frame up to a time budget, and one idle job worker keeps going between frames while no
+//other jobs are queued. Within a priority tasks take turns a step at a time, so one long task can't hold up the rest.
+class BackgroundScheduler
+{
+private:
+	static background_scheduler_ptr s_Instance;
+
+	struct BackgroundTask
+	{
+		BackgroundStep mStep;
+		float mAverageStepMicroseconds = 0.0f;
+	};
+	//Tasks that must stay on the game thread, and tasks any thread can step
+	std::deque<BackgroundTask> mGameThreadTasks[static_cast<uint32_t>(BackgroundPriority::Count)];
+	std::deque<BackgroundTask> mAnyThreadTasks[static_cast<uint32_t>(BackgroundPriority::Count)];
+	std::mutex mTaskMutex;
+
+	std::chrono::microseconds mFrameBudget;
+	Job mWorkerJob;
+	std::atomic<bool> mWorkerRunning;
+	std::atomic<bool> mShutdown;
+
+	BackgroundScheduler();
+	//Takes the first task in priority order, game thread tasks first at the same priority when gameThread is set
+	bool PopTask(bool gameThread, BackgroundTask& task, BackgroundPriority& priority, bool& anyThread);
+	//Front puts a task that was taken but not run back where it was
+	void PushTask(BackgroundTask&& task, BackgroundPriority priority, bool anyThread, bool front);
+	bool HasAnyThreadTasks();
+	static bool RunStep(BackgroundTask& task);
+	//Steps any thread tasks on a job worker until the job system has something better to do
+	void RunWorker();
+	void StartWorker();
+public:
+	static void CreateInstance();
+	static const background_scheduler_ptr& Instance();
+	static void DestroyInstance();
+
+	//From any thread. Game thread tasks are only ever stepped from RunFrameSlice, any thread ones may also be stepped on a
+	//job worker, never on two threads at once.
+	void Submit(BackgroundStep step, BackgroundPriority priority = BackgroundPriority::Normal, bool anyThread = true);
+	//co_await BackgroundScheduler::Instance()->Yield() carries on as one background step on a job worker or in a frame
+	//slice. Lets a coroutine break long work up with a preemption point between each piece.
+	struct YieldAwaiter
+	{
+		BackgroundScheduler* mScheduler;
+		BackgroundPriority mPriority;
+		bool await_ready() const noexcept { return false; }
+		void await_suspend(coro::coroutine_handle<> coroutine)
+		{
+			mScheduler->Submit([coroutine]() { coroutine.resume(); return false; }, mPriority, true);
+		}
+		void await_resume() noexcept {}
+	};
+	YieldAwaiter Yield(BackgroundPriority priority = BackgroundPriority::Low) { return YieldAwaiter{ this, priority }; }
+
+	void SetFrameBudget(std::chrono::microseconds budget) { mFrameBudget = budget; }
+	std::chrono::microseconds GetFrameBudget() const { return mFrameBudget; }
+	//Game thread, once a frame. Steps tasks until the budget is spent, and won't start a step it expects to run past it.
+	//Returns how many steps ran.
+	uint32_t RunFrameSlice();
+
+	~BackgroundScheduler();
+};
\ No newline at end of file
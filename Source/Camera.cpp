@@ -1,50 +1,65 @@
 #include "precompiled.hpp"
 #include "Matrix4.hpp"
+#include "AffineTransform.hpp"
 #include "Vector3.hpp"
 #include "Vector4.hpp"
 #include "Quaternion.hpp"
-#include "Application.hpp"
+#include "FastMath.hpp"
 #include "MathConstants.hpp"
+#include "Frustum.hpp"
+#include "TransformStore.hpp"
 #include "Camera.hpp"
 
-Camera::Camera()
+Camera::Camera(float aspectRatio)
 	: mFov(50.0f),
+	mAspectRatio(aspectRatio),
 	mNearPlane(0.1f),
-	mFarPlane(1000.f)
+	mFarPlane(1000.f),
+	mTransform(TransformStore::Instance()->Create())
 {
-	mAspectRatio = (float)Application::Instance()->GetWidth() / (float)Application::Instance()->GetHeight();
 	mPosition = Vector3(0.0f, 0.0f, 5.0f);
 	mLocalZ = (mPosition - Vector3(0.0f, 0.0f, 0.0f)).GetNormal();
 	mLocalX = up.Cross(mLocalZ);
 	mLocalY = mLocalZ.Cross(mLocalX);
+	PushTransform();
+}
+
+Camera::~Camera()
+{
+	TransformStore::Instance()->Destroy(mTransform);
+}
+
+void Camera::PushTransform()
+{
+	TransformStore::Instance()->SetLocalTRS(mTransform, mPosition, Quaternion::FromAxes(mLocalX, mLocalY, mLocalZ), Vector3(1.0f, 1.0f, 1.0f));
 }
 
 void Camera::MoveLocalZ(float dist)
 {
 	mPosition = mPosition + (mLocalZ * dist);
+	PushTransform();
 }
 
 void Camera::MoveLocalX(float dist)
 {
 	mPosition = mPosition + (mLocalX * dist);
+	PushTransform();
 }
 
 void Camera::MoveLocalY(float dist)
 {
 	mPosition = mPosition + (mLocalY * dist);
+	PushTransform();
 }
 
 void Camera::RotateYaw(float degree)
 {
 	if (degree != 0.0f)
 	{
-		Quaternion rotate = {};
-		rotate.RotateAngleAxis(degree, up);
-		Vector4 vec = Vector4(mLocalZ, 1.0f);
-		mLocalZ = rotate.GetMatrix() * vec;
-		mLocalZ = mLocalZ.GetNormal();
-		mLocalX = up.Cross(mLocalZ).GetNormal();
-		mLocalY = mLocalZ.Cross(mLocalX).GetNormal();
+		mLocalZ = FastMath::Normalize(Quaternion::FromAngleAxisFast(-degree, up).Rotate(mLocalZ));
+		mLocalX = FastMath::Normalize(up.Cross(mLocalZ));
+		mLocalY = FastMath::Normalize(mLocalZ.Cross(mLocalX));
+		PushTransform();
 	}
 }
 
@@ -52,19 +67,15 @@ void Camera::RotatePitch(float degree)
 {
 	if (degree != 0.0f)
 	{
-		Quaternion rotate = {};
-		rotate.RotateAngleAxis(-degree, mLocalX);
-		Vector4 vec = Vector4(mLocalZ, 1.0f);
-		Vector3 newLook = {};
-		newLook = rotate.GetMatrix() * vec;
-		newLook = newLook.GetNormal();
+		const Vector3 newLook = FastMath::Normalize(Quaternion::FromAngleAxisFast(degree, mLocalX).Rotate(mLocalZ));
 		float dot = newLook.Dot(up);
 
 		if (abs(dot) < 0.999f)
 		{
 			mLocalZ = newLook;
-			mLocalX = up.Cross(mLocalZ).GetNormal();
-			mLocalY = mLocalZ.Cross(mLocalX).GetNormal();
+			mLocalX = FastMath::Normalize(up.Cross(mLocalZ));
+			mLocalY = FastMath::Normalize(mLocalZ.Cross(mLocalX));
+			PushTransform();
 		}
 	}
 }
@@ -72,6 +83,7 @@ void Camera::RotatePitch(float degree)
 void Camera::SetPosition(const Vector3 & pos)
 {
 	mPosition = pos;
+	PushTransform();
 }
 
 void Camera::SetLookAt(const Vector3 & target)
@@ -79,35 +91,68 @@ void Camera::SetLookAt(const Vector3 & target)
 	mLocalZ = (mPosition - target).GetNormal();
 	mLocalX = up.Cross(mLocalZ);
 	mLocalY = mLocalZ.Cross(mLocalX);
+	PushTransform();
+}
+
+void Camera::UpdateMatrices() const
+{
+	const TransformStore& store = *TransformStore::Instance();
+	const uint32_t worldVersion = store.GetWorldVersion(mTransform);
+	const bool viewDirty = worldVersion != mViewVersion;
+	if (!viewDirty && !mProjectionDirty)
+	{
+		return;
+	}
+
+	const AffineTransform& world = store.GetWorldMatrix(mTransform);
+	if (viewDirty)
+	{
+		//Full inverse rather than InverseRigid so a scaled parent still gives a correct view
+		mView = world.Inverse();
+		mViewVersion = worldVersion;
+	}
+
+	if (mProjectionDirty)
+	{
+		mProjection = Matrix4::Perspective(mFov, mAspectRatio, mNearPlane, mFarPlane);
+		mInverseProjection = mProjection.Inverse();
+	}
+
+	const Matrix4 view = mView.ToMatrix4();
+	mViewProjection = mProjection * view;
+	//The inverse view is the camera's world matrix, only the projection needs a real inverse
+	mInverseViewProjection = world.ToMatrix4() * mInverseProjection;
+	mFrustum.ExtractPlanes(mViewProjection);
+
+	mProjectionDirty = false;
 }
 
-Matrix4 Camera::GetView() const
-{
-	const float dx = -mLocalX.Dot(mPosition);
-	const float dy = -mLocalY.Dot(mPosition);
-	const float dz = -mLocalZ.Dot(mPosition);
-	return Matrix4
-	(
-		mLocalX.x, mLocalX.y, mLocalX.z, dx,
-		mLocalY.x, mLocalY.y, mLocalY.z, dy,
-		mLocalZ.x, mLocalZ.y, mLocalZ.z, dz,
-		0.0f, 0.0f, 0.0f, 1.0f
-	);
+const AffineTransform& Camera::GetView() const
+{
+	UpdateMatrices();
+	return mView;
+}
+
+const Matrix4& Camera::GetProjection() const
+{
+	UpdateMatrices();
+	return mProjection;
 }
 
-Matrix4 Camera::GetProjection() const
-{
-	const float halffovtan = tan((mFov * piOver180) * 0.5f);
-	const float h = 1 / halffovtan;
-	const float w = 1 / (halffovtan * mAspectRatio);
-	const float fp = mFarPlane;
-	const float np = mNearPlane;
-
-	return Matrix4
-	(
-		w, 0.0f, 0.0f, 0.0f,
-		0.0f, h, 0.0f, 0.0f,
-		0.0f, 0.0f, fp / (np - fp), -(fp * np) / (fp - np),
-		0.0f, 0.0f, -1.0f, 0.0f
-	);
+const Matrix4& Camera::GetViewProjection() const
+{
+	UpdateMatrices();
+	return mViewProjection;
+}
+
+const Matrix4& Camera::GetInverseViewProjection() const
+{
+	UpdateMatrices();
+	return mInverseViewProjection;
+}
+
+const Frustum& Camera::GetFrustum() const
+{
+	UpdateMatrices();
+	return mFrustum;
 }
\ No newline at end of file
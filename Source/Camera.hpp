@@ -1,7 +1,10 @@
 #pragma once
 #include "Vector3.hpp"
+#include "Matrix4.hpp"
+#include "AffineTransform.hpp"
+#include "Frustum.hpp"
+#include "TransformStore.hpp"
 
-class Matrix4;
 class Camera
 {
 private:
@@ -13,8 +16,28 @@ private:
 	Vector3 mLocalX;
 	Vector3 mLocalY;
 	Vector3 mPosition;
+	//Position and axes above are relative to the parent node, the store turns them into the world matrix the view comes from
+	TransformHandle mTransform;
+
+	//Rebuilt on the first Get after the camera or anything it is parented to moves, so any number of Move/Rotate calls in
+	//a frame cost one rebuild. The Gets read the world matrix as of the last TransformStore::UpdateWorldMatrices and never
+	//run it themselves, so moves only show up once the frame has updated the store, as Graphics::Draw does first.
+	mutable AffineTransform mView;
+	mutable Matrix4 mProjection;
+	mutable Matrix4 mInverseProjection;
+	mutable Matrix4 mViewProjection;
+	mutable Matrix4 mInverseViewProjection;
+	mutable Frustum mFrustum;
+	mutable uint32_t mViewVersion = 0;
+	mutable bool mProjectionDirty = true;
+
+	void PushTransform();
+	void UpdateMatrices() const;
 public:
-	Camera();
+	explicit Camera(float aspectRatio);
+	Camera(const Camera&) = delete;
+	Camera& operator=(const Camera&) = delete;
+	~Camera();
 	void MoveLocalZ(float dist);
 	void MoveLocalX(float dist);
 	void MoveLocalY(float dist);
@@ -23,10 +46,14 @@ public:
 
 	void SetPosition(const Vector3& pos);
 	void SetLookAt(const Vector3& target);
-	void SetFov(float fov) { mFov = fov; }
+	void SetFov(float fov) { mFov = fov; mProjectionDirty = true; }
 
 	const Vector3& GetPosition() const { return mPosition; }
+	TransformHandle GetTransform() const { return mTransform; }
 
-	Matrix4 GetView() const;
-	Matrix4 GetProjection() const;
+	const AffineTransform& GetView() const;
+	const Matrix4& GetProjection() const;
+	const Matrix4& GetViewProjection() const;
+	const Matrix4& GetInverseViewProjection() const;
+	const Frustum& GetFrustum() const;
 };
\ No newline at end of file
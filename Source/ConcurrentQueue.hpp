@@ -0,0 +1,165 @@
+#pragma once
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <new>
+#include <utility>
+
+//Bounded ring for exactly one producer thread and one consumer thread, no locks and no allocation after construction.
+//Each side keeps a copy of the other side's index and only reloads it when the ring looks full or empty, so in the
+//steady state a push or pop touches a single shared cache line.
+template<typename T, uint32_t Capacity>
+class SPSCQueue
+{
+	static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "SPSCQueue capacity has to be a power of two");
+private:
+	static constexpr uint32_t CacheLine = 64;
+
+	alignas(CacheLine) std::atomic<uint32_t> mHead; //Next slot to pop, written by the consumer
+	uint32_t mCachedTail;
+	alignas(CacheLine) std::atomic<uint32_t> mTail; //Next slot to push, written by the producer
+	uint32_t mCachedHead;
+	alignas(CacheLine) T mSlots[Capacity];
+public:
+	SPSCQueue() : mHead(0), mCachedTail(0), mTail(0), mCachedHead(0) {}
+	SPSCQueue(const SPSCQueue&) = delete;
+	SPSCQueue& operator=(const SPSCQueue&) = delete;
+
+	//Producer only. False when full, value is left untouched.
+	template<typename U>
+	bool TryPush(U&& value)
+	{
+		const uint32_t tail = mTail.load(std::memory_order_relaxed);
+		if (tail - mCachedHead == Capacity)
+		{
+			mCachedHead = mHead.load(std::memory_order_acquire);
+			if (tail - mCachedHead == Capacity)
+			{
+				return false;
+			}
+		}
+		mSlots[tail & (Capacity - 1)] = std::forward<U>(value);
+		mTail.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	//Consumer only. False when empty.
+	bool TryPop(T& value)
+	{
+		const uint32_t head = mHead.load(std::memory_order_relaxed);
+		if (head == mCachedTail)
+		{
+			mCachedTail = mTail.load(std::memory_order_acquire);
+			if (head == mCachedTail)
+			{
+				return false;
+			}
+		}
+		value = std::move(mSlots[head & (Capacity - 1)]);
+		mHead.store(head + 1, std::memory_order_release);
+		return true;
+	}
+
+	//Exact from either end's own thread when the other end is idle, a snapshot otherwise
+	bool IsEmpty() const { return mHead.load(std::memory_order_acquire) == mTail.load(std::memory_order_acquire); }
+	static constexpr uint32_t GetCapacity() { return Capacity; }
+};
+
+//Bounded ring any number of threads can push to and pop from, no locks and no allocation after construction. Every slot
+//carries a sequence number saying whose turn it is, so a push or pop is one CAS on the shared index plus a store to the
+//slot, and threads only ever wait on each other when the ring is full or empty. Not FIFO across producers, each
+//producer's own items do come out in the order it pushed them.
+template<typename T, uint32_t Capacity>
+class MPMCQueue
+{
+	static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "MPMCQueue capacity has to be a power of two");
+private:
+	static constexpr uint32_t CacheLine = 64;
+
+	struct Slot
+	{
+		std::atomic<uint32_t> mSequence;
+		T mValue;
+	};
+
+	alignas(CacheLine) std::atomic<uint32_t> mTail; //Next position to push
+	alignas(CacheLine) std::atomic<uint32_t> mHead; //Next position to pop
+	alignas(CacheLine) Slot mSlots[Capacity];
+public:
+	MPMCQueue() : mTail(0), mHead(0)
+	{
+		for (uint32_t i = 0; i < Capacity; ++i)
+		{
+			mSlots[i].mSequence.store(i, std::memory_order_relaxed);
+		}
+	}
+	MPMCQueue(const MPMCQueue&) = delete;
+	MPMCQueue& operator=(const MPMCQueue&) = delete;
+
+	//False when full, value is left untouched
+	template<typename U>
+	bool TryPush(U&& value)
+	{
+		uint32_t position = mTail.load(std::memory_order_relaxed);
+		Slot* slot;
+		for (;;)
+		{
+			slot = &mSlots[position & (Capacity - 1)];
+			//Equal means the slot is free for this position, behind means a lap ago's value hasn't been popped yet
+			const int32_t difference = static_cast<int32_t>(slot->mSequence.load(std::memory_order_acquire) - position);
+			if (difference == 0)
+			{
+				if (mTail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+				{
+					break;
+				}
+			}
+			else if (difference < 0)
+			{
+				return false;
+			}
+			else
+			{
+				position = mTail.load(std::memory_order_relaxed);
+			}
+		}
+		slot->mValue = std::forward<U>(value);
+		slot->mSequence.store(position + 1, std::memory_order_release);
+		return true;
+	}
+
+	//False when empty
+	bool TryPop(T& value)
+	{
+		uint32_t position = mHead.load(std::memory_order_relaxed);
+		Slot* slot;
+		for (;;)
+		{
+			slot = &mSlots[position & (Capacity - 1)];
+			const int32_t difference = static_cast<int32_t>(slot->mSequence.load(std::memory_order_acquire) - (position + 1));
+			if (difference == 0)
+			{
+				if (mHead.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+				{
+					break;
+				}
+			}
+			else if (difference < 0)
+			{
+				return false;
+			}
+			else
+			{
+				position = mHead.load(std::memory_order_relaxed);
+			}
+		}
+		value = std::move(slot->mValue);
+		//Hands the slot to the push one lap from now
+		slot->mSequence.store(position + Capacity, std::memory_order_release);
+		return true;
+	}
+
+	//A snapshot, only exact when nothing else is pushing or popping
+	bool IsEmpty() const { return mHead.load(std::memory_order_acquire) == mTail.load(std::memory_order_acquire); }
+	static constexpr uint32_t GetCapacity() { return Capacity; }
+};
\ No newline at end of file
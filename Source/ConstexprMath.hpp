@@ -0,0 +1,90 @@
+#pragma once
+#include <cstdint>
+#include <limits>
+
+//Compile time stand ins for <cmath>, which is not constexpr on our toolset. Meant for building constants,
+//at runtime the <cmath> versions are faster and these should not show up in hot code.
+namespace ConstexprMath
+{
+	constexpr double cPi = 3.14159265358979323846;
+	constexpr double cTau = 6.28318530717958647692;
+
+	constexpr float Abs(float x)
+	{
+		return x < 0.0f ? -x : x;
+	}
+
+	//Newton's method in double, converges in a handful of steps for anything near 1 and under 70 for the float range
+	constexpr float Sqrt(float x)
+	{
+		if (x < 0.0f || x != x)
+		{
+			return std::numeric_limits<float>::quiet_NaN();
+		}
+		if (x == 0.0f || x == std::numeric_limits<float>::infinity())
+		{
+			return x;
+		}
+
+		const double value = x;
+		double guess = value > 1.0 ? value : 1.0;
+		for (uint32_t i = 0; i < 128; ++i)
+		{
+			const double next = 0.5 * (guess + value / guess);
+			if (next == guess)
+			{
+				break;
+			}
+			guess = next;
+		}
+		return static_cast<float>(guess);
+	}
+
+	//Reduces to [-pi/2, pi/2] then runs the Taylor series out far enough for full float precision
+	constexpr double SinDouble(double x)
+	{
+		x -= cTau * static_cast<double>(static_cast<int64_t>(x / cTau));
+		if (x > cPi)
+		{
+			x -= cTau;
+		}
+		else if (x < -cPi)
+		{
+			x += cTau;
+		}
+
+		if (x > cPi * 0.5)
+		{
+			x = cPi - x;
+		}
+		else if (x < -cPi * 0.5)
+		{
+			x = -cPi - x;
+		}
+
+		const double x2 = x * x;
+		double term = x;
+		double sum = x;
+		for (uint32_t i = 1; i < 12; ++i)
+		{
+			term *= -x2 / static_cast<double>((2 * i) * (2 * i + 1));
+			sum += term;
+		}
+		return sum;
+	}
+
+	constexpr float Sin(float radians)
+	{
+		return static_cast<float>(SinDouble(radians));
+	}
+
+	constexpr float Cos(float radians)
+	{
+		return static_cast<float>(SinDouble(static_cast<double>(radians) + cPi * 0.5));
+	}
+
+	constexpr float Tan(float radians)
+	{
+		return static_cast<float>(SinDouble(radians) / SinDouble(static_cast<double>(radians) + cPi * 0.5));
+	}
+}
\ No newline at end of file
@@ -0,0 +1,242 @@
+#include "precompiled.hpp"
+#include "EntityWorld.hpp"
+
+#include <algorithm>
+
+entity_world_ptr EntityWorld::s_Instance = nullptr;
+
+namespace
+{
+	//Plain arrays are never destroyed, so archetypes torn down by the singleton after main returns can still read them
+	ComponentInfo s_ComponentInfos[MaxComponentTypes];
+	uint32_t s_ComponentCount = 0;
+
+	size_t AlignUp(size_t value, size_t alignment)
+	{
+		return (value + alignment - 1) & ~(alignment - 1);
+	}
+}
+
+ComponentId RegisterComponent(const ComponentInfo& info)
+{
+	assert(s_ComponentCount < MaxComponentTypes);
+	assert(info.mAlignment <= Archetype::CacheLine);
+	s_ComponentInfos[s_ComponentCount] = info;
+	return s_ComponentCount++;
+}
+
+const ComponentInfo& GetComponentInfo(ComponentId id)
+{
+	return s_ComponentInfos[id];
+}
+
+Archetype::Archetype(ComponentMask mask) :
+	mMask(mask)
+{
+	size_t bytesPerEntity = sizeof(Entity);
+	for (ComponentId id = 0; id < MaxComponentTypes; ++id)
+	{
+		mOffsets[id] = 0;
+		if (Has(id))
+		{
+			mComponentIds.push_back(id);
+			bytesPerEntity += GetComponentInfo(id).mSize;
+		}
+	}
+
+	//Every array can waste up to a cache line of padding, take that off the top before dividing
+	const size_t padding = CacheLine * (mComponentIds.size() + 1);
+	assert(bytesPerEntity <= ChunkBytes - padding);
+	mChunkCapacity = static_cast<uint32_t>((ChunkBytes - padding) / bytesPerEntity);
+
+	size_t offset = AlignUp(sizeof(Entity) * mChunkCapacity, CacheLine);
+	for (ComponentId id : mComponentIds)
+	{
+		mOffsets[id] = offset;
+		offset = AlignUp(offset + (GetComponentInfo(id).mSize * mChunkCapacity), CacheLine);
+	}
+	assert(offset <= ChunkBytes);
+}
+
+Archetype::~Archetype()
+{
+	for (Chunk& chunk : mChunks)
+	{
+		for (ComponentId id : mComponentIds)
+		{
+			const ComponentInfo& info = GetComponentInfo(id);
+			for (uint32_t row = 0; row < chunk.mCount; ++row)
+			{
+				info.mDestroy(GetComponent(chunk, id, row));
+			}
+		}
+		operator delete(chunk.mData, std::align_val_t(CacheLine));
+	}
+}
+
+void Archetype::Allocate(Entity entity, uint32_t& chunkIndex, uint32_t& row)
+{
+	if (mChunks.empty() || mChunks.back().mCount == mChunkCapacity)
+	{
+		mChunks.push_back(Chunk{ static_cast<uint8_t*>(operator new(ChunkBytes, std::align_val_t(CacheLine))), 0 });
+	}
+	chunkIndex = static_cast<uint32_t>(mChunks.size() - 1);
+	Chunk& chunk = mChunks.back();
+	row = chunk.mCount++;
+	GetEntities(chunk)[row] = entity;
+}
+
+Entity Archetype::Remove(uint32_t chunkIndex, uint32_t row)
+{
+	const Chunk& chunk = mChunks[chunkIndex];
+	for (ComponentId id : mComponentIds)
+	{
+		GetComponentInfo(id).mDestroy(GetComponent(chunk, id, row));
+	}
+	return FillHole(chunkIndex, row);
+}
+
+Entity Archetype::RemoveMoved(uint32_t chunkIndex, uint32_t row)
+{
+	return FillHole(chunkIndex, row);
+}
+
+Entity Archetype::FillHole(uint32_t chunkIndex, uint32_t row)
+{
+	//Swap in the very last row so every chunk but the last stays full
+	Chunk& last = mChunks.back();
+	const uint32_t lastRow = last.mCount - 1;
+	Entity moved;
+	if (chunkIndex != mChunks.size() - 1 || row != lastRow)
+	{
+		const Chunk& hole = mChunks[chunkIndex];
+		for (ComponentId id : mComponentIds)
+		{
+			const ComponentInfo& info = GetComponentInfo(id);
+			void* source = GetComponent(last, id, lastRow);
+			info.mMoveConstruct(GetComponent(hole, id, row), source);
+			info.mDestroy(source);
+		}
+		moved = GetEntities(last)[lastRow];
+		GetEntities(hole)[row] = moved;
+	}
+
+	if (--last.mCount == 0)
+	{
+		operator delete(last.mData, std::align_val_t(CacheLine));
+		mChunks.pop_back();
+	}
+	return moved;
+}
+
+void EntityWorld::CreateInstance()
+{
+	if (s_Instance == nullptr)
+	{
+		s_Instance = static_cast<entity_world_ptr>(new EntityWorld());
+	}
+}
+
+const entity_world_ptr & EntityWorld::Instance()
+{
+	assert(s_Instance != nullptr);
+	return s_Instance;
+}
+
+void EntityWorld::DestroyInstance()
+{
+	s_Instance.reset();
+}
+
+Archetype& EntityWorld::FindOrCreateArchetype(ComponentMask mask)
+{
+	std::unique_ptr<Archetype>& archetype = mArchetypeLookup[mask];
+	if (archetype == nullptr)
+	{
+		archetype.reset(new Archetype(mask));
+		mArchetypes.push_back(archetype.get());
+	}
+	return *archetype;
+}
+
+Entity EntityWorld::AllocateEntity(Archetype& archetype)
+{
+	Entity entity;
+	if (!mFreeRecords.empty())
+	{
+		entity.mIndex = mFreeRecords.back();
+		mFreeRecords.pop_back();
+	}
+	else
+	{
+		entity.mIndex = static_cast<uint32_t>(mRecords.size());
+		mRecords.push_back(EntityRecord());
+	}
+
+	EntityRecord& record = mRecords[entity.mIndex];
+	entity.mGeneration = record.mGeneration;
+	record.mArchetype = &archetype;
+	archetype.Allocate(entity, record.mChunk, record.mRow);
+	++mEntityCount;
+	return entity;
+}
+
+void EntityWorld::DestroyEntity(Entity entity)
+{
+	assert(IsAlive(entity));
+	EntityRecord& record = mRecords[entity.mIndex];
+	const Entity moved = record.mArchetype->Remove(record.mChunk, record.mRow);
+	if (moved.IsValid())
+	{
+		Relocated(moved, record.mChunk, record.mRow);
+	}
+
+	record.mArchetype = nullptr;
+	++record.mGeneration;
+	mFreeRecords.push_back(entity.mIndex);
+	--mEntityCount;
+}
+
+bool EntityWorld::IsAlive(Entity entity) const
+{
+	return entity.mIndex < mRecords.size() && mRecords[entity.mIndex].mArchetype != nullptr && mRecords[entity.mIndex].mGeneration == entity.mGeneration;
+}
+
+void* EntityWorld::GetComponent(Entity entity, ComponentId id) const
+{
+	const EntityRecord& record = mRecords[entity.mIndex];
+	return record.mArchetype->GetComponent(record.mArchetype->GetChunk(record.mChunk), id, record.mRow);
+}
+
+void EntityWorld::ChangeArchetype(Entity entity, ComponentMask mask)
+{
+	assert(IsAlive(entity));
+	EntityRecord& record = mRecords[entity.mIndex];
+	Archetype& source = *record.mArchetype;
+	Archetype& destination = FindOrCreateArchetype(mask);
+
+	uint32_t chunkIndex;
+	uint32_t row;
+	destination.Allocate(entity, chunkIndex, row);
+	const Archetype::Chunk& from = source.GetChunk(record.mChunk);
+	const Archetype::Chunk& to = destination.GetChunk(chunkIndex);
+	for (ComponentId id : source.GetComponentIds())
+	{
+		const ComponentInfo& info = GetComponentInfo(id);
+		void* component = source.GetComponent(from, id, record.mRow);
+		if (destination.Has(id))
+		{
+			info.mMoveConstruct(destination.GetComponent(to, id, row), component);
+		}
+		info.mDestroy(component);
+	}
+
+	const Entity moved = source.RemoveMoved(record.mChunk, record.mRow);
+	if (moved.IsValid())
+	{
+		Relocated(moved, record.mChunk, record.mRow);
+	}
+	record.mArchetype = &destination;
+	record.mChunk = chunkIndex;
+	record.mRow = row;
+}
\ No newline at end of file
@@ -0,0 +1,246 @@
+#pragma once
+#include <new>
+#include <unordered_map>
+#include "JobSystem.hpp"
+
+//Stays valid until the entity is destroyed, a stale handle is caught by the generation check
+struct Entity
+{
+	static constexpr uint32_t InvalidIndex = 0xffffffffu;
+	uint32_t mIndex = InvalidIndex;
+	uint32_t mGeneration = 0;
+
+	bool IsValid() const { return mIndex != InvalidIndex; }
+	bool operator==(const Entity& b) const { return mIndex == b.mIndex && mGeneration == b.mGeneration; }
+};
+
+typedef uint32_t ComponentId;
+typedef uint64_t ComponentMask;
+constexpr uint32_t MaxComponentTypes = 64;
+
+//Enough about a component type to move and destroy it without knowing what it is
+struct ComponentInfo
+{
+	size_t mSize;
+	size_t mAlignment;
+	void(*mMoveConstruct)(void* destination, void* source);
+	void(*mDestroy)(void* component);
+};
+
+ComponentId RegisterComponent(const ComponentInfo& info);
+const ComponentInfo& GetComponentInfo(ComponentId id);
+
+//Ids are handed out the first time each type is used
+template<typename T>
+ComponentId GetComponentId()
+{
+	static const ComponentId id = RegisterComponent(ComponentInfo
+	{
+		sizeof(T),
+		alignof(T),
+		[](void* destination, void* source) { new (destination) T(std::move(*static_cast<T*>(source))); },
+		[](void* component) { static_cast<T*>(component)->~T(); }
+	});
+	return id;
+}
+
+template<typename... Ts>
+ComponentMask GetComponentMask()
+{
+	return (ComponentMask(0) | ... | (ComponentMask(1) << GetComponentId<Ts>()));
+}
+
+//Every entity with exactly the same set of components lives in the same archetype. Its entities are packed into fixed
+//size chunks, and inside a chunk each component type gets its own array starting on a cache line. A system that only
+//reads small hot components never pulls the big cold ones into cache.
+class Archetype
+{
+public:
+	static constexpr size_t ChunkBytes = 16 * 1024;
+	static constexpr size_t CacheLine = 64;
+
+	struct Chunk
+	{
+		uint8_t* mData;
+		uint32_t mCount;
+	};
+
+	Archetype(ComponentMask mask);
+	~Archetype();
+	Archetype(const Archetype&) = delete;
+	Archetype& operator=(const Archetype&) = delete;
+
+	ComponentMask GetMask() const { return mMask; }
+	uint32_t GetChunkCapacity() const { return mChunkCapacity; }
+	size_t GetChunkCount() const { return mChunks.size(); }
+	Chunk& GetChunk(size_t index) { return mChunks[index]; }
+	bool Has(ComponentId id) const { return (mMask & (ComponentMask(1) << id)) != 0; }
+
+	Entity* GetEntities(const Chunk& chunk) const { return reinterpret_cast<Entity*>(chunk.mData); }
+	void* GetComponent(const Chunk& chunk, ComponentId id, uint32_t row) const { return chunk.mData + mOffsets[id] + (row * GetComponentInfo(id).mSize); }
+	template<typename T>
+	T* GetArray(const Chunk& chunk) const { return reinterpret_cast<T*>(chunk.mData + mOffsets[GetComponentId<T>()]); }
+
+	//Reserves a row at the end for entity, the caller constructs the components in place
+	void Allocate(Entity entity, uint32_t& chunkIndex, uint32_t& row);
+	//Destroys the row's components and fills the hole with the archetype's last row. Returns the entity that moved in,
+	//or an invalid entity when the removed row was the last one.
+	Entity Remove(uint32_t chunkIndex, uint32_t row);
+	//Same as Remove but leaves the components alone, used once they have been moved to another archetype
+	Entity RemoveMoved(uint32_t chunkIndex, uint32_t row);
+
+	const std::vector<ComponentId>& GetComponentIds() const { return mComponentIds; }
+
+private:
+	ComponentMask mMask;
+	std::vector<ComponentId> mComponentIds;
+	size_t mOffsets[MaxComponentTypes];
+	uint32_t mChunkCapacity;
+	std::vector<Chunk> mChunks;
+
+	Entity FillHole(uint32_t chunkIndex, uint32_t row);
+};
+
+class EntityWorld;
+typedef std::unique_ptr<EntityWorld> entity_world_ptr;
+class EntityWorld
+{
+private:
+	static entity_world_ptr s_Instance;
+
+	struct EntityRecord
+	{
+		Archetype* mArchetype = nullptr;
+		uint32_t mChunk = 0;
+		uint32_t mRow = 0;
+		uint32_t mGeneration = 0;
+	};
+
+	std::unordered_map<ComponentMask, std::unique_ptr<Archetype>> mArchetypeLookup;
+	std::vector<Archetype*> mArchetypes;
+	std::vector<EntityRecord> mRecords;
+	std::vector<uint32_t> mFreeRecords;
+	size_t mEntityCount = 0;
+
+	EntityWorld() {}
+	Archetype& FindOrCreateArchetype(ComponentMask mask);
+	Entity AllocateEntity(Archetype& archetype);
+	void* GetComponent(Entity entity, ComponentId id) const;
+	//Moves entity into the archetype for mask, constructing nothing new and destroying the components it loses
+	void ChangeArchetype(Entity entity, ComponentMask mask);
+	void Relocated(Entity entity, uint32_t chunk, uint32_t row) { mRecords[entity.mIndex].mChunk = chunk; mRecords[entity.mIndex].mRow = row; }
+public:
+	static void CreateInstance();
+	static const entity_world_ptr& Instance();
+	static void DestroyInstance();
+
+	template<typename... Ts>
+	Entity CreateEntity(Ts&&... components)
+	{
+		Archetype& archetype = FindOrCreateArchetype(GetComponentMask<typename std::decay<Ts>::type...>());
+		const Entity entity = AllocateEntity(archetype);
+		const EntityRecord& record = mRecords[entity.mIndex];
+		Archetype::Chunk& chunk = archetype.GetChunk(record.mChunk);
+		(void)chunk;
+		(new (&archetype.GetArray<typename std::decay<Ts>::type>(chunk)[record.mRow]) typename std::decay<Ts>::type(std::forward<Ts>(components)), ...);
+		return entity;
+	}
+	void DestroyEntity(Entity entity);
+	bool IsAlive(Entity entity) const;
+	size_t GetEntityCount() const { return mEntityCount; }
+
+	template<typename T>
+	bool Has(Entity entity) const
+	{
+		assert(IsAlive(entity));
+		return mRecords[entity.mIndex].mArchetype->Has(GetComponentId<T>());
+	}
+	//Pointers are only good until the next create, destroy, add or remove, any of which can move components around
+	template<typename T>
+	T* Get(Entity entity) const
+	{
+		return Has<T>(entity) ? static_cast<T*>(GetComponent(entity, GetComponentId<T>())) : nullptr;
+	}
+
+	template<typename T>
+	T& AddComponent(Entity entity, T component)
+	{
+		assert(!Has<T>(entity));
+		ChangeArchetype(entity, mRecords[entity.mIndex].mArchetype->GetMask() | GetComponentMask<T>());
+		return *new (GetComponent(entity, GetComponentId<T>())) T(std::move(component));
+	}
+	template<typename T>
+	void RemoveComponent(Entity entity)
+	{
+		assert(Has<T>(entity));
+		ChangeArchetype(entity, mRecords[entity.mIndex].mArchetype->GetMask() & ~GetComponentMask<T>());
+	}
+
+	//Calls function(count, entities, Ts*...) once per chunk holding at least all of Ts and none of excluded, each pointer
+	//is the start of a packed array of count components. Don't create or destroy entities from inside.
+	template<typename... Ts, typename Function>
+	void ForEachChunk(Function&& function, ComponentMask excluded = 0)
+	{
+		const ComponentMask required = GetComponentMask<Ts...>();
+		for (Archetype* archetype : mArchetypes)
+		{
+			if ((archetype->GetMask() & required) != required || (archetype->GetMask() & excluded) != 0)
+			{
+				continue;
+			}
+			for (size_t i = 0; i < archetype->GetChunkCount(); ++i)
+			{
+				const Archetype::Chunk& chunk = archetype->GetChunk(i);
+				if (chunk.mCount != 0)
+				{
+					function(chunk.mCount, archetype->GetEntities(chunk), archetype->GetArray<Ts>(chunk)...);
+				}
+			}
+		}
+	}
+	//ForEachChunk with the chunks spread over the job threads. Chunks run concurrently, so function may only write to the
+	//chunk it was handed or to something owned by JobSystem::GetThreadIndex(), anything shared has to wait until it returns.
+	template<typename... Ts, typename Function>
+	void ParallelForEachChunk(Function&& function)
+	{
+		const ComponentMask required = GetComponentMask<Ts...>();
+		std::vector<std::pair<Archetype*, Archetype::Chunk*>> chunks;
+		for (Archetype* archetype : mArchetypes)
+		{
+			if ((archetype->GetMask() & required) != required)
+			{
+				continue;
+			}
+			for (size_t i = 0; i < archetype->GetChunkCount(); ++i)
+			{
+				if (archetype->GetChunk(i).mCount != 0)
+				{
+					chunks.emplace_back(archetype, &archetype->GetChunk(i));
+				}
+			}
+		}
+
+		//A chunk is already a few hundred entities, plenty to amortise a job over
+		JobSystem::Instance()->ParallelFor(0, static_cast<uint32_t>(chunks.size()), 1, [&chunks, &function](uint32_t begin, uint32_t end)
+		{
+			for (uint32_t i = begin; i < end; ++i)
+			{
+				Archetype& archetype = *chunks[i].first;
+				const Archetype::Chunk& chunk = *chunks[i].second;
+				function(chunk.mCount, archetype.GetEntities(chunk), archetype.GetArray<Ts>(chunk)...);
+			}
+		});
+	}
+	//Calls function(Ts&...) for every matching entity
+	template<typename... Ts, typename Function>
+	void ForEach(Function&& function)
+	{
+		ForEachChunk<Ts...>([&function](uint32_t count, const Entity*, Ts*... arrays)
+		{
+			for (uint32_t i = 0; i < count; ++i)
+			{
+				function(arrays[i]...);
+			}
+		});
+	}
+};
\ No newline at end of file
@@ -0,0 +1,198 @@
+#include "precompiled.hpp"
+#include "MathSIMD.hpp"
+#include "Vector3.hpp"
+#include "TransformBatch.hpp"
+#include "FastMath.hpp"
+
+#include <cfloat>
+#include <algorithm>
+
+namespace
+{
+	constexpr float cTwoOverPi = 0.636619772367581343f;
+	//pi/2 split into three parts so j * part1 and j * part2 are exact for the quadrant counts we support
+	constexpr float cHalfPi1 = 1.5703125f;
+	constexpr float cHalfPi2 = 4.837512969970703125e-4f;
+	constexpr float cHalfPi3 = 7.54978995489188216e-8f;
+
+	//Minimax coefficients for [-pi/4, pi/4], the same ones Cephes uses for sinf and cosf
+	constexpr float cSin1 = -1.6666654611e-1f;
+	constexpr float cSin2 = 8.3321608736e-3f;
+	constexpr float cSin3 = -1.9515295891e-4f;
+	constexpr float cCos1 = 4.166664568298827e-2f;
+	constexpr float cCos2 = -1.388731625493765e-3f;
+	constexpr float cCos3 = 2.443315711809948e-5f;
+
+	inline float RsqrtScalar(float x)
+	{
+#if defined(MATH_SIMD_SSE2)
+		const float estimate = _mm_cvtss_f32(_mm_rsqrt_ss(_mm_set_ss(x)));
+#else
+		//Bit trick estimate is only good to about 3%, two extra steps bring it level with rsqrtss
+		union { float f; uint32_t i; } bits = { x };
+		bits.i = 0x5f375a86u - (bits.i >> 1);
+		float estimate = bits.f;
+		estimate = estimate * (1.5f - (0.5f * x * estimate * estimate));
+		estimate = estimate * (1.5f - (0.5f * x * estimate * estimate));
+#endif
+		return estimate * (1.5f - (0.5f * x * estimate * estimate));
+	}
+
+#if defined(MATH_SIMD_SSE2)
+	inline __m128 RsqrtSSE(__m128 x)
+	{
+		const __m128 estimate = _mm_rsqrt_ps(x);
+		const __m128 halfX = _mm_mul_ps(_mm_set1_ps(0.5f), x);
+		return _mm_mul_ps(estimate, _mm_sub_ps(_mm_set1_ps(1.5f), _mm_mul_ps(halfX, _mm_mul_ps(estimate, estimate))));
+	}
+#endif
+}
+
+float FastMath::Rsqrt(float x)
+{
+	return RsqrtScalar(x);
+}
+
+void FastMath::RsqrtBatch(const float* in, float* out, size_t count)
+{
+	size_t i = 0;
+#if defined(MATH_SIMD_SSE2)
+	for (; i + 4 <= count; i += 4)
+	{
+		_mm_storeu_ps(out + i, RsqrtSSE(_mm_loadu_ps(in + i)));
+	}
+#endif
+	for (; i < count; ++i)
+	{
+		out[i] = RsqrtScalar(in[i]);
+	}
+}
+
+Vector3 FastMath::Normalize(const Vector3& vec)
+{
+	//Clamping to the smallest normal float keeps the estimate finite, so a zero vector scales to zero instead of NaN
+	const float lengthSquared = (std::max)(vec.MagnitudeSquared(), FLT_MIN);
+	return vec * RsqrtScalar(lengthSquared);
+}
+
+void FastMath::NormalizeBatch(ConstVector3Stream in, Vector3Stream out, size_t count)
+{
+	size_t i = 0;
+#if defined(MATH_SIMD_SSE2)
+	const __m128 smallest = _mm_set1_ps(FLT_MIN);
+	for (; i + 4 <= count; i += 4)
+	{
+		const __m128 x = _mm_loadu_ps(in.x + i);
+		const __m128 y = _mm_loadu_ps(in.y + i);
+		const __m128 z = _mm_loadu_ps(in.z + i);
+		const __m128 lengthSquared = _mm_max_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z)), smallest);
+		const __m128 scale = RsqrtSSE(lengthSquared);
+		_mm_storeu_ps(out.x + i, _mm_mul_ps(x, scale));
+		_mm_storeu_ps(out.y + i, _mm_mul_ps(y, scale));
+		_mm_storeu_ps(out.z + i, _mm_mul_ps(z, scale));
+	}
+#endif
+	for (; i < count; ++i)
+	{
+		const Vector3 normal = Normalize(Vector3(in.x[i], in.y[i], in.z[i]));
+		out.x[i] = normal.x;
+		out.y[i] = normal.y;
+		out.z[i] = normal.z;
+	}
+}
+
+void FastMath::SinCos(float radians, float& sine, float& cosine)
+{
+	const float scaled = radians * cTwoOverPi;
+	const int32_t quadrant = static_cast<int32_t>(scaled + (scaled >= 0.0f ? 0.5f : -0.5f));
+	const float j = static_cast<float>(quadrant);
+	const float r = ((radians - (j * cHalfPi1)) - (j * cHalfPi2)) - (j * cHalfPi3);
+	const float r2 = r * r;
+
+	const float s = r + (r * r2 * (cSin1 + r2 * (cSin2 + r2 * cSin3)));
+	const float c = 1.0f - (0.5f * r2) + (r2 * r2 * (cCos1 + r2 * (cCos2 + r2 * cCos3)));
+
+	switch (quadrant & 3)
+	{
+	case 0:
+		sine = s;
+		cosine = c;
+		break;
+	case 1:
+		sine = c;
+		cosine = -s;
+		break;
+	case 2:
+		sine = -s;
+		cosine = -c;
+		break;
+	default:
+		sine = -c;
+		cosine = s;
+		break;
+	}
+}
+
+float FastMath::Sin(float radians)
+{
+	float sine;
+	float cosine;
+	SinCos(radians, sine, cosine);
+	return sine;
+}
+
+float FastMath::Cos(float radians)
+{
+	float sine;
+	float cosine;
+	SinCos(radians, sine, cosine);
+	return cosine;
+}
+
+float FastMath::Tan(float radians)
+{
+	float sine;
+	float cosine;
+	SinCos(radians, sine, cosine);
+	return sine / cosine;
+}
+
+void FastMath::SinCosBatch(const float* radians, float* sines, float* cosines, size_t count)
+{
+	size_t i = 0;
+#if defined(MATH_SIMD_SSE2)
+	const __m128i one = _mm_set1_epi32(1);
+	const __m128i two = _mm_set1_epi32(2);
+	for (; i + 4 <= count; i += 4)
+	{
+		const __m128 x = _mm_loadu_ps(radians + i);
+		const __m128i quadrant = _mm_cvtps_epi32(_mm_mul_ps(x, _mm_set1_ps(cTwoOverPi)));
+		const __m128 j = _mm_cvtepi32_ps(quadrant);
+		__m128 r = _mm_sub_ps(x, _mm_mul_ps(j, _mm_set1_ps(cHalfPi1)));
+		r = _mm_sub_ps(r, _mm_mul_ps(j, _mm_set1_ps(cHalfPi2)));
+		r = _mm_sub_ps(r, _mm_mul_ps(j, _mm_set1_ps(cHalfPi3)));
+		const __m128 r2 = _mm_mul_ps(r, r);
+
+		__m128 s = _mm_add_ps(_mm_set1_ps(cSin2), _mm_mul_ps(r2, _mm_set1_ps(cSin3)));
+		s = _mm_add_ps(_mm_set1_ps(cSin1), _mm_mul_ps(r2, s));
+		s = _mm_add_ps(r, _mm_mul_ps(_mm_mul_ps(r, r2), s));
+
+		__m128 c = _mm_add_ps(_mm_set1_ps(cCos2), _mm_mul_ps(r2, _mm_set1_ps(cCos3)));
+		c = _mm_add_ps(_mm_set1_ps(cCos1), _mm_mul_ps(r2, c));
+		c = _mm_add_ps(_mm_sub_ps(_mm_set1_ps(1.0f), _mm_mul_ps(_mm_set1_ps(0.5f), r2)), _mm_mul_ps(_mm_mul_ps(r2, r2), c));
+
+		//Odd quadrants swap sine and cosine, the sign bits come straight from the quadrant bits
+		const __m128 swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(quadrant, one), one));
+		const __m128 sineSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(quadrant, two), 30));
+		const __m128 cosineSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(_mm_add_epi32(quadrant, one), two), 30));
+		const __m128 sine = _mm_or_ps(_mm_and_ps(swap, c), _mm_andnot_ps(swap, s));
+		const __m128 cosine = _mm_or_ps(_mm_and_ps(swap, s), _mm_andnot_ps(swap, c));
+		_mm_storeu_ps(sines + i, _mm_xor_ps(sine, sineSign));
+		_mm_storeu_ps(cosines + i, _mm_xor_ps(cosine, cosineSign));
+	}
+#endif
+	for (; i < count; ++i)
+	{
+		SinCos(radians[i], sines[i], cosines[i]);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,27 @@
+#pragma once
+
+struct Vector3Stream;
+struct ConstVector3Stream;
+class Vector3;
+
+//Opt in approximations for hot loops. Nothing here calls into libm. Error bounds were measured against double precision
+//<cmath> over the stated input range, abs is absolute error and rel is relative error.
+namespace FastMath
+{
+	//rsqrt estimate plus one Newton-Raphson step. rel < 2.5e-7 (about two float ulps) for normal positive inputs.
+	float Rsqrt(float x);
+	void RsqrtBatch(const float* in, float* out, size_t count);
+
+	//Zero length vectors come back as zero instead of asserting. The result's length is within 2.5e-7 of 1.
+	Vector3 Normalize(const Vector3& vec);
+	void NormalizeBatch(ConstVector3Stream in, Vector3Stream out, size_t count);
+
+	//Cody-Waite reduction to [-pi/4, pi/4] then minimax polynomials. abs < 3e-7 for |radians| <= 8192 * pi,
+	//accuracy falls off past that as the reduction runs out of bits.
+	void SinCos(float radians, float& sine, float& cosine);
+	float Sin(float radians);
+	float Cos(float radians);
+	//Sin over Cos, rel is about 3e-7 / |cos(radians)| so it stays under 3e-4 while |cos| > 1e-3
+	float Tan(float radians);
+	void SinCosBatch(const float* radians, float* sines, float* cosines, size_t count);
+}
\ No newline at end of file
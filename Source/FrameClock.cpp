@@ -0,0 +1,73 @@
+#include "precompiled.hpp"
+#include "FrameClock.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+namespace
+{
+	//A frame longer than this is a breakpoint or a stall, not something the simulation should try to catch up on
+	constexpr double cMaxFrameSeconds = 0.25;
+	//Sleeps can overshoot by about a scheduler tick, so the last stretch before a capped frame is spent yielding instead
+	constexpr std::chrono::milliseconds cSleepMargin(2);
+}
+
+FrameClock::FrameClock(double simulationHz) :
+	mLastFrame(Clock::now()),
+	mNextFrame(mLastFrame),
+	mStepSeconds(1.0 / simulationHz)
+{
+}
+
+void FrameClock::SetRenderRateCap(double hz)
+{
+	mFrameInterval = hz > 0.0 ? std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / hz)) : Clock::duration::zero();
+	mNextFrame = Clock::now() + mFrameInterval;
+}
+
+void FrameClock::BeginFrame()
+{
+	if (mFrameInterval != Clock::duration::zero())
+	{
+		if (mNextFrame - Clock::now() > cSleepMargin)
+		{
+			std::this_thread::sleep_until(mNextFrame - cSleepMargin);
+		}
+		while (Clock::now() < mNextFrame)
+		{
+			std::this_thread::yield();
+		}
+		//Keep to the cap's own schedule so the rate doesn't drift, unless a frame ran long enough to miss a slot
+		mNextFrame += mFrameInterval;
+		const Clock::time_point now = Clock::now();
+		if (mNextFrame < now)
+		{
+			mNextFrame = now + mFrameInterval;
+		}
+	}
+
+	const Clock::time_point now = Clock::now();
+	mFrameSeconds = std::chrono::duration<double>(now - mLastFrame).count();
+	mLastFrame = now;
+	mAccumulator += (std::min)(mFrameSeconds, cMaxFrameSeconds);
+	mStepsThisFrame = 0;
+}
+
+bool FrameClock::ConsumeStep()
+{
+	if (mAccumulator < mStepSeconds)
+	{
+		return false;
+	}
+	if (mStepsThisFrame == mMaxStepsPerFrame)
+	{
+		//Behind by more than a frame's worth of steps, forget the rest rather than fall further behind next frame
+		mAccumulator = std::fmod(mAccumulator, mStepSeconds);
+		return false;
+	}
+	mAccumulator -= mStepSeconds;
+	++mStepsThisFrame;
+	++mStepCount;
+	return true;
+}
\ No newline at end of file
@@ -0,0 +1,45 @@
+#pragma once
+#include <chrono>
+
+//Splits real time into fixed simulation steps and works out how far between the last two steps each rendered frame falls.
+//Simulation always advances by GetStepSeconds however fast frames are drawn, so the render rate can be capped or left
+//uncapped and the simulation rate lowered without the game running any faster or slower.
+//  clock.BeginFrame();
+//  while (clock.ConsumeStep()) { simulate(clock.GetStepSeconds()); }
+//  draw(clock.GetAlpha());
+class FrameClock
+{
+public:
+	typedef std::chrono::steady_clock Clock;
+private:
+	Clock::time_point mLastFrame;
+	Clock::time_point mNextFrame;
+	double mStepSeconds;
+	double mAccumulator = 0.0;
+	double mFrameSeconds = 0.0;
+	Clock::duration mFrameInterval = Clock::duration::zero();
+	uint32_t mMaxStepsPerFrame = 8;
+	uint32_t mStepsThisFrame = 0;
+	uint64_t mStepCount = 0;
+public:
+	explicit FrameClock(double simulationHz = 60.0);
+
+	void SetSimulationRate(double hz) { mStepSeconds = 1.0 / hz; }
+	//0 draws as fast as it can, anything else sleeps in BeginFrame to hold frames to that rate
+	void SetRenderRateCap(double hz);
+	//Steps beyond this in one frame are dropped and the game slows down instead, so a slow simulation can't snowball
+	void SetMaxStepsPerFrame(uint32_t steps) { mMaxStepsPerFrame = steps; }
+
+	//Top of every frame. Waits out the render cap, then adds the time since the last frame to what the simulation owes.
+	void BeginFrame();
+	//True once for every whole step owed, run one simulation step each time
+	bool ConsumeStep();
+
+	float GetStepSeconds() const { return static_cast<float>(mStepSeconds); }
+	//0 to 1, how far the current frame is from the last simulation state towards the next one
+	float GetAlpha() const { return static_cast<float>(mAccumulator / mStepSeconds); }
+	//Real time between the last two BeginFrames
+	float GetFrameSeconds() const { return static_cast<float>(mFrameSeconds); }
+	uint32_t GetStepsThisFrame() const { return mStepsThisFrame; }
+	uint64_t GetStepCount() const { return mStepCount; }
+};
\ No newline at end of file
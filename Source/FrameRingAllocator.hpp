@@ -0,0 +1,91 @@
+#pragma once
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+//Per frame scratch memory carved out of one fixed ring. Any thread can allocate at any time with a single CAS, nothing is
+//freed on its own. Instead EndFrame marks where the current frame's allocations stop and ReleaseFrame, once whoever
+//reads that frame's data (usually the GPU) is done, hands everything up to that mark back in one go.
+//Capacity has to be a power of two, alignments a power of two no bigger than a cache line.
+class FrameRingAllocator
+{
+public:
+	static constexpr uint32_t MaxFramesInFlight = 4;
+	static constexpr size_t CacheLine = 64;
+
+	explicit FrameRingAllocator(size_t capacity) :
+		mMemory(static_cast<uint8_t*>(operator new(capacity, std::align_val_t(CacheLine)))),
+		mCapacity(capacity),
+		mHead(0),
+		mTail(0),
+		mFrame(0),
+		mReleasedFrames(0)
+	{
+		assert(capacity != 0 && (capacity & (capacity - 1)) == 0);
+	}
+	~FrameRingAllocator() { operator delete(mMemory, std::align_val_t(CacheLine)); }
+	FrameRingAllocator(const FrameRingAllocator&) = delete;
+	FrameRingAllocator& operator=(const FrameRingAllocator&) = delete;
+
+	//Any thread. Null when the frames not yet released already hold too much of the ring, an allocation never wraps
+	//around the end so it may skip whatever is left there.
+	void* Allocate(size_t size, size_t alignment = 16)
+	{
+		assert(size <= mCapacity && alignment <= CacheLine && (alignment & (alignment - 1)) == 0);
+		//Offsets only ever grow, the ring position is the offset masked by the capacity
+		uint64_t head = mHead.load(std::memory_order_relaxed);
+		for (;;)
+		{
+			uint64_t start = AlignUp(head, alignment);
+			if ((start & (mCapacity - 1)) + size > mCapacity)
+			{
+				start = AlignUp(head, mCapacity);
+			}
+			const uint64_t end = start + size;
+			if (end - mTail.load(std::memory_order_acquire) > mCapacity)
+			{
+				return nullptr;
+			}
+			if (mHead.compare_exchange_weak(head, end, std::memory_order_relaxed))
+			{
+				return mMemory + (start & (mCapacity - 1));
+			}
+		}
+	}
+
+	template<typename T>
+	T* Allocate(size_t count = 1) { return static_cast<T*>(Allocate(sizeof(T) * count, alignof(T))); }
+
+	//Owner thread, with nothing else allocating. Closes the current frame and returns its index.
+	uint64_t EndFrame()
+	{
+		assert(mFrame - mReleasedFrames.load(std::memory_order_acquire) < MaxFramesInFlight);
+		mFrameEnds[mFrame % MaxFramesInFlight] = mHead.load(std::memory_order_relaxed);
+		return mFrame++;
+	}
+
+	//Any one thread at a time, frames in the order they ended. Everything allocated up to the end of frame can be reused.
+	void ReleaseFrame(uint64_t frame)
+	{
+		assert(frame == mReleasedFrames.load(std::memory_order_relaxed));
+		mTail.store(mFrameEnds[frame % MaxFramesInFlight], std::memory_order_release);
+		mReleasedFrames.store(frame + 1, std::memory_order_release);
+	}
+
+	size_t GetCapacity() const { return mCapacity; }
+	//Bytes held by frames that have not been released yet, including the current one
+	size_t GetUsed() const { return static_cast<size_t>(mHead.load(std::memory_order_relaxed) - mTail.load(std::memory_order_relaxed)); }
+
+private:
+	uint8_t* mMemory;
+	size_t mCapacity;
+	alignas(CacheLine) std::atomic<uint64_t> mHead;
+	alignas(CacheLine) std::atomic<uint64_t> mTail;
+	alignas(CacheLine) uint64_t mFrame;
+	std::atomic<uint64_t> mReleasedFrames;
+	uint64_t mFrameEnds[MaxFramesInFlight];
+
+	static uint64_t AlignUp(uint64_t value, uint64_t alignment) { return (value + alignment - 1) & ~(alignment - 1); }
+};
\ No newline at end of file
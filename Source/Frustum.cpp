@@ -0,0 +1,183 @@
+#include "precompiled.hpp"
+#include "MathSIMD.hpp"
+#include "Vector3.hpp"
+#include "Vector4.hpp"
+#include "Matrix4.hpp"
+#include "Frustum.hpp"
+
+namespace
+{
+	//Appends the set lanes of mask without branching, every lane writes and only the passing ones advance the cursor
+	inline uint32_t AppendVisible(int mask, uint32_t lanes, uint32_t base, uint32_t* visibleIndices, uint32_t visibleCount)
+	{
+		for (uint32_t lane = 0; lane < lanes; ++lane)
+		{
+			visibleIndices[visibleCount] = base + lane;
+			visibleCount += (mask >> lane) & 1;
+		}
+		return visibleCount;
+	}
+}
+
+void Frustum::ExtractPlanes(const Matrix4& viewProjection)
+{
+	const auto row = [&viewProjection](uint32_t i)
+	{
+		return Vector4(viewProjection.matrix[0][i], viewProjection.matrix[1][i], viewProjection.matrix[2][i], viewProjection.matrix[3][i]);
+	};
+	const Vector4 row0 = row(0);
+	const Vector4 row1 = row(1);
+	const Vector4 row2 = row(2);
+	const Vector4 row3 = row(3);
+
+	mPlanes[Left] = Vector4(row3.x + row0.x, row3.y + row0.y, row3.z + row0.z, row3.w + row0.w);
+	mPlanes[Right] = Vector4(row3.x - row0.x, row3.y - row0.y, row3.z - row0.z, row3.w - row0.w);
+	mPlanes[Bottom] = Vector4(row3.x + row1.x, row3.y + row1.y, row3.z + row1.z, row3.w + row1.w);
+	mPlanes[Top] = Vector4(row3.x - row1.x, row3.y - row1.y, row3.z - row1.z, row3.w - row1.w);
+	mPlanes[Near] = row2;
+	mPlanes[Far] = Vector4(row3.x - row2.x, row3.y - row2.y, row3.z - row2.z, row3.w - row2.w);
+
+	for (auto& plane : mPlanes)
+	{
+		const float dec = 1.0f / sqrt((plane.x * plane.x) + (plane.y * plane.y) + (plane.z * plane.z));
+		plane = Vector4(plane.x * dec, plane.y * dec, plane.z * dec, plane.w * dec);
+	}
+}
+
+bool Frustum::TestSphere(const Vector3& center, float radius) const
+{
+	for (const auto& plane : mPlanes)
+	{
+		if ((plane.x * center.x) + (plane.y * center.y) + (plane.z * center.z) + plane.w < -radius)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+bool Frustum::TestBox(const Vector3& center, const Vector3& extents) const
+{
+	for (const auto& plane : mPlanes)
+	{
+		const float distance = (plane.x * center.x) + (plane.y * center.y) + (plane.z * center.z) + plane.w;
+		const float radius = (fabs(plane.x) * extents.x) + (fabs(plane.y) * extents.y) + (fabs(plane.z) * extents.z);
+		if (distance < -radius)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+uint32_t Frustum::CullSpheres(const SphereStream& spheres, uint32_t count, uint32_t* visibleIndices) const
+{
+	uint32_t visibleCount = 0;
+	uint32_t i = 0;
+#if defined(MATH_SIMD_AVX2)
+	for (; i + 8 <= count; i += 8)
+	{
+		const __m256 x = _mm256_loadu_ps(spheres.x + i);
+		const __m256 y = _mm256_loadu_ps(spheres.y + i);
+		const __m256 z = _mm256_loadu_ps(spheres.z + i);
+		const __m256 negRadius = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(spheres.radius + i));
+		__m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+		for (const auto& plane : mPlanes)
+		{
+			const __m256 distance = _mm256_fmadd_ps(_mm256_set1_ps(plane.z), z,
+				_mm256_fmadd_ps(_mm256_set1_ps(plane.y), y, _mm256_fmadd_ps(_mm256_set1_ps(plane.x), x, _mm256_set1_ps(plane.w))));
+			inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, negRadius, _CMP_GE_OQ));
+		}
+		visibleCount = AppendVisible(_mm256_movemask_ps(inside), 8, i, visibleIndices, visibleCount);
+	}
+#endif
+#if defined(MATH_SIMD_SSE2)
+	for (; i + 4 <= count; i += 4)
+	{
+		const __m128 x = _mm_loadu_ps(spheres.x + i);
+		const __m128 y = _mm_loadu_ps(spheres.y + i);
+		const __m128 z = _mm_loadu_ps(spheres.z + i);
+		const __m128 negRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(spheres.radius + i));
+		__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+		for (const auto& plane : mPlanes)
+		{
+			const __m128 distance = _mm_add_ps(
+				_mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.x), x), _mm_mul_ps(_mm_set1_ps(plane.y), y)),
+				_mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.z), z), _mm_set1_ps(plane.w)));
+			inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negRadius));
+		}
+		visibleCount = AppendVisible(_mm_movemask_ps(inside), 4, i, visibleIndices, visibleCount);
+	}
+#endif
+	for (; i < count; ++i)
+	{
+		visibleIndices[visibleCount] = i;
+		visibleCount += TestSphere(Vector3(spheres.x[i], spheres.y[i], spheres.z[i]), spheres.radius[i]) ? 1 : 0;
+	}
+	return visibleCount;
+}
+
+uint32_t Frustum::CullBoxes(const BoxStream& boxes, uint32_t count, uint32_t* visibleIndices) const
+{
+	uint32_t visibleCount = 0;
+	uint32_t i = 0;
+#if defined(MATH_SIMD_AVX2)
+	{
+		const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+		for (; i + 8 <= count; i += 8)
+		{
+			const __m256 x = _mm256_loadu_ps(boxes.centerX + i);
+			const __m256 y = _mm256_loadu_ps(boxes.centerY + i);
+			const __m256 z = _mm256_loadu_ps(boxes.centerZ + i);
+			const __m256 ex = _mm256_loadu_ps(boxes.extentX + i);
+			const __m256 ey = _mm256_loadu_ps(boxes.extentY + i);
+			const __m256 ez = _mm256_loadu_ps(boxes.extentZ + i);
+			__m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+			for (const auto& plane : mPlanes)
+			{
+				const __m256 nx = _mm256_set1_ps(plane.x);
+				const __m256 ny = _mm256_set1_ps(plane.y);
+				const __m256 nz = _mm256_set1_ps(plane.z);
+				const __m256 distance = _mm256_fmadd_ps(nz, z, _mm256_fmadd_ps(ny, y, _mm256_fmadd_ps(nx, x, _mm256_set1_ps(plane.w))));
+				//Projected half size of the box onto the plane normal
+				const __m256 radius = _mm256_fmadd_ps(_mm256_and_ps(nz, absMask), ez,
+					_mm256_fmadd_ps(_mm256_and_ps(ny, absMask), ey, _mm256_mul_ps(_mm256_and_ps(nx, absMask), ex)));
+				inside = _mm256_and_ps(inside, _mm256_cmp_ps(_mm256_add_ps(distance, radius), _mm256_setzero_ps(), _CMP_GE_OQ));
+			}
+			visibleCount = AppendVisible(_mm256_movemask_ps(inside), 8, i, visibleIndices, visibleCount);
+		}
+	}
+#endif
+#if defined(MATH_SIMD_SSE2)
+	{
+		const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+		for (; i + 4 <= count; i += 4)
+		{
+			const __m128 x = _mm_loadu_ps(boxes.centerX + i);
+			const __m128 y = _mm_loadu_ps(boxes.centerY + i);
+			const __m128 z = _mm_loadu_ps(boxes.centerZ + i);
+			const __m128 ex = _mm_loadu_ps(boxes.extentX + i);
+			const __m128 ey = _mm_loadu_ps(boxes.extentY + i);
+			const __m128 ez = _mm_loadu_ps(boxes.extentZ + i);
+			__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+			for (const auto& plane : mPlanes)
+			{
+				const __m128 nx = _mm_set1_ps(plane.x);
+				const __m128 ny = _mm_set1_ps(plane.y);
+				const __m128 nz = _mm_set1_ps(plane.z);
+				const __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, x), _mm_mul_ps(ny, y)), _mm_add_ps(_mm_mul_ps(nz, z), _mm_set1_ps(plane.w)));
+				const __m128 radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_and_ps(nx, absMask), ex), _mm_mul_ps(_mm_and_ps(ny, absMask), ey)),
+					_mm_mul_ps(_mm_and_ps(nz, absMask), ez));
+				inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(distance, radius), _mm_setzero_ps()));
+			}
+			visibleCount = AppendVisible(_mm_movemask_ps(inside), 4, i, visibleIndices, visibleCount);
+		}
+	}
+#endif
+	for (; i < count; ++i)
+	{
+		visibleIndices[visibleCount] = i;
+		visibleCount += TestBox(Vector3(boxes.centerX[i], boxes.centerY[i], boxes.centerZ[i]), Vector3(boxes.extentX[i], boxes.extentY[i], boxes.extentZ[i])) ? 1 : 0;
+	}
+	return visibleCount;
+}
\ No newline at end of file
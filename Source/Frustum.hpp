@@ -0,0 +1,61 @@
+#pragma once
+#include "Vector3.hpp"
+#include "Vector4.hpp"
+
+class Matrix4;
+
+struct BoundingSphere
+{
+	Vector3 mCenter;
+	float mRadius = 0.0f;
+};
+
+//Structure of arrays bounds for the batched tests, every stream holds count floats
+struct SphereStream
+{
+	const float* x;
+	const float* y;
+	const float* z;
+	const float* radius;
+};
+
+struct BoxStream
+{
+	const float* centerX;
+	const float* centerY;
+	const float* centerZ;
+	const float* extentX;
+	const float* extentY;
+	const float* extentZ;
+};
+
+class alignas(16) Frustum
+{
+public:
+	enum Plane : uint32_t
+	{
+		Left,
+		Right,
+		Bottom,
+		Top,
+		Near,
+		Far,
+		PlaneCount
+	};
+
+	Vector4 mPlanes[PlaneCount]; //Normal in xyz pointing inwards, distance in w
+
+	Frustum() = default;
+	explicit Frustum(const Matrix4& viewProjection) { ExtractPlanes(viewProjection); }
+
+	//Gribb/Hartmann extraction from projection * view, expects Vulkan's 0 to 1 clip depth
+	void ExtractPlanes(const Matrix4& viewProjection);
+
+	bool TestSphere(const Vector3& center, float radius) const;
+	bool TestBox(const Vector3& center, const Vector3& extents) const;
+
+	//Tests 4 or 8 volumes per iteration and writes the indices of the ones that pass, in order, to visibleIndices.
+	//visibleIndices needs room for count entries. Returns how many were written.
+	uint32_t CullSpheres(const SphereStream& spheres, uint32_t count, uint32_t* visibleIndices) const;
+	uint32_t CullBoxes(const BoxStream& boxes, uint32_t count, uint32_t* visibleIndices) const;
+};
\ No newline at end of file
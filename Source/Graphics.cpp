@@ -3,13 +3,35 @@
 #include "Vector3.hpp"
 #include "Matrix4.hpp"
 #include "Camera.hpp"
+#include "TransformStore.hpp"
+#include "EntityWorld.hpp"
+#include "Frustum.hpp"
 #include "RenderVertex.hpp"
 #include "RenderObject.hpp"
+#include "JobSystem.hpp"
 #include "Graphics.hpp"
 
+#include <chrono>
+#include <future>
+
 graphics_ptr Graphics::s_Instance = nullptr;
 
-Graphics::Graphics()
+Graphics::Graphics() :
+	mFramesDrawn(0),
+	mRenderThreadSleeping(false)
+{
+	//Vulkan is brought up on the render thread itself so nothing else ever touches the queue or swapchain
+	std::promise<void> initialized;
+	mRenderThread = std::thread([this, &initialized]()
+	{
+		InitializeRender();
+		initialized.set_value();
+		RenderLoop();
+	});
+	initialized.get_future().wait();
+}
+
+void Graphics::InitializeRender()
 {
 	hal::Render::CreateInstance();
 	hal::Render::Instance()->SetRenderLayout(&mRenderLayout);
@@ -27,7 +49,7 @@ Graphics::Graphics()
 	mRenderPassLayout = new hal::RenderPassLayout(mSwapchainAttachments);
 	mRenderPass = new hal::RenderPass(mRenderPassLayout);
 
-	mDescriptorLayouts = { new hal::DescriptorLayout(hal::ShaderStage::Vertex, hal::LayoutBindingDescriptor::UniformBuffer, 0) };
+	mDescriptorLayouts = { new hal::DescriptorLayout(hal::ShaderStage::Vertex, hal::LayoutBindingDescriptor::DynamicUniformBuffer, 0), new hal::DescriptorLayout(hal::ShaderStage::Vertex, hal::LayoutBindingDescriptor::UniformBuffer, 1) };
 
 	mInputVector = { new hal::InputAttributes(VK_FORMAT_R32G32B32_SFLOAT, offsetof(RenderVertex, RenderVertex::mPosition)), new hal::InputAttributes(VK_FORMAT_R32G32B32_SFLOAT, offsetof(RenderVertex, RenderVertex::mColor)) }; //Store array
 	mShaderInputLayout = new hal::ShaderInputLayout(mInputVector, sizeof(RenderVertex), mDescriptorLayouts);
@@ -35,17 +57,29 @@ Graphics::Graphics()
 	mPipelineLayout = new hal::PipelineLayout(mShaderInfos, mShaderInputLayout);
 	mPipelineLayout->SetRenderPass(mRenderPass); //Move to constructor
 
-	mMatricesBuffer = new hal::Buffer(sizeof(TransformMatracies), reinterpret_cast<uint8_t*>(&mTransformMatracies), hal::BufferType::UniformBuffer);
-	mMatraciesDescriptor = new hal::BufferDescriptor(mDescriptorLayouts[0], mMatricesBuffer);
-	mPipelineDescriptors = { mMatraciesDescriptor };
-	mDescriptorPool = new hal::DescriptorPool(mPipelineDescriptors, mPipelineLayout);
+	//Dynamic offsets have to land on the device's alignment, so blocks are spaced out to it
+	const VkDeviceSize offsetAlignment = (std::max)(hal::Render::Instance()->GetVulkanDevice().GetPhysicalDeviceProperties().limits.minUniformBufferOffsetAlignment, static_cast<VkDeviceSize>(alignof(TransformMatracies)));
+	mUniformStride = static_cast<uint32_t>((sizeof(TransformMatracies) + offsetAlignment - 1) / offsetAlignment * offsetAlignment);
+	mUniformScratch.assign(InitialObjectCapacity * mUniformStride, 0);
+
+	mFrameUniforms.resize(hal::Render::Instance()->GetFramesInFlight());
+	for (FrameUniforms& uniforms : mFrameUniforms)
+	{
+		uniforms.mObjectCapacity = InitialObjectCapacity;
+		uniforms.mMatricesBuffer = new hal::Buffer(InitialObjectCapacity * mUniformStride, mUniformScratch.data(), hal::BufferType::UniformBuffer);
+		uniforms.mMatraciesDescriptor = new hal::BufferDescriptor(mDescriptorLayouts[0], uniforms.mMatricesBuffer, sizeof(TransformMatracies));
+		uniforms.mViewProjectionBuffer = new hal::Buffer(sizeof(Matrix4), mUniformScratch.data(), hal::BufferType::UniformBuffer);
+		uniforms.mViewProjectionDescriptor = new hal::BufferDescriptor(mDescriptorLayouts[1], uniforms.mViewProjectionBuffer);
+		uniforms.mPipelineDescriptors = { uniforms.mMatraciesDescriptor, uniforms.mViewProjectionDescriptor };
+		uniforms.mDescriptorPool = new hal::DescriptorPool(uniforms.mPipelineDescriptors, mPipelineLayout);
+	}
 
 	mPipeline = new hal::Pipeline(mPipelineLayout);
 
+	//A pool for every job thread and one spare for anything else that ends up recording
+	hal::Render::Instance()->SetRecordingThreadCount(JobSystem::Instance()->GetThreadCount() + 1);
 	hal::Render::Instance()->InitializeRender(mRenderPass, mSwapchainDepthStencil);
 	mSetupCommandBuffer->EndAndSubmitSetupBuffer();
-
-	hal::Render::Instance()->AddRenderInfo(&mRenderInfo);
 }
 
 void Graphics::CreateInstance()
@@ -68,40 +102,418 @@ void Graphics::DestroyInstance()
 	s_Instance = nullptr;
 }
 
-void Graphics::AddRenderObject(RenderObject* renderObject)
+void Graphics::Draw(float alpha)
+{
+	TransformStore::Instance()->UpdateWorldMatrices();
+	RenderFrame& frame = mFrames[mFramesIssued & 1];
+	frame.mViewProjection = mMainCamera->GetViewProjection();
+
+	mCulling.mCenterX.clear();
+	mCulling.mCenterY.clear();
+	mCulling.mCenterZ.clear();
+	mCulling.mRadius.clear();
+	mCulling.mTransforms.clear();
+	mCulling.mMeshes.clear();
+	const TransformStore& store = *TransformStore::Instance();
+	//Static objects aren't culled, they are drawn from the cached buffer whether on screen or not
+	EntityWorld::Instance()->ForEachChunk<RenderTransform, RenderBounds, RenderMeshComponent>([this, &store](uint32_t count, const Entity*, const RenderTransform* transforms, const RenderBounds* bounds, const RenderMeshComponent* meshes)
+	{
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			const AffineTransform& model = store.GetWorldMatrix(transforms[i].mTransform);
+			const Vector3 center = model.TransformPoint(bounds[i].mLocalBounds.mCenter);
+			mCulling.mCenterX.push_back(center.x);
+			mCulling.mCenterY.push_back(center.y);
+			mCulling.mCenterZ.push_back(center.z);
+			mCulling.mRadius.push_back(bounds[i].mLocalBounds.mRadius * model.GetMaxScale());
+			mCulling.mTransforms.push_back(transforms[i].mTransform);
+			mCulling.mMeshes.push_back(meshes[i].mMesh);
+		}
+	}, GetComponentMask<RenderStatic>());
+
+	const uint32_t objectCount = static_cast<uint32_t>(mCulling.mMeshes.size());
+	mCulling.mVisibleObjects.resize(objectCount);
+
+	const Frustum& frustum = mMainCamera->GetFrustum();
+	const SphereStream spheres = { mCulling.mCenterX.data(), mCulling.mCenterY.data(), mCulling.mCenterZ.data(), mCulling.mRadius.data() };
+	mCulling.mVisibleObjects.resize(frustum.CullSpheres(spheres, objectCount, mCulling.mVisibleObjects.data()));
+
+	//The world matrices are copied out so the game can move things again while this frame is drawn. Culling used the
+	//latest state, which is never more than a step from the interpolated one.
+	frame.mModelMatrices.clear();
+	frame.mMeshes.clear();
+	for (uint32_t index : mCulling.mVisibleObjects)
+	{
+		frame.mModelMatrices.push_back(store.GetInterpolatedWorldMatrix(mCulling.mTransforms[index], alpha));
+		frame.mMeshes.push_back(mCulling.mMeshes[index]);
+	}
+
+	if (mStaticDirty)
+	{
+		RebuildStaticScene();
+	}
+	frame.mStaticScene = mStaticScene;
+
+	//The other frame's buffer is next to be filled, so the frame before this one has to be finished with it
+	if (mFramesDrawn.load(std::memory_order_acquire) < mFramesIssued)
+	{
+		std::unique_lock<std::mutex> lock(mWakeMutex);
+		mWakeCondition.wait(lock, [this]() { return mFramesDrawn.load(std::memory_order_acquire) >= mFramesIssued; });
+	}
+	PushCommand(RenderCommand{ RenderCommand::Type::DrawFrame, static_cast<uint32_t>(mFramesIssued & 1), nullptr });
+	++mFramesIssued;
+}
+
+void Graphics::RebuildStaticScene()
+{
+	std::shared_ptr<StaticScene> scene = std::make_shared<StaticScene>();
+	scene->mVersion = ++mStaticVersion;
+	const TransformStore& store = *TransformStore::Instance();
+	EntityWorld::Instance()->ForEachChunk<RenderTransform, RenderMeshComponent, RenderStatic>([&scene, &store](uint32_t count, const Entity*, const RenderTransform* transforms, const RenderMeshComponent* meshes, const RenderStatic*)
+	{
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			scene->mModelMatrices.push_back(store.GetWorldMatrix(transforms[i].mTransform));
+			scene->mMeshes.push_back(meshes[i].mMesh);
+		}
+	});
+
+	if (scene->mMeshes.empty())
+	{
+		mStaticScene = nullptr;
+	}
+	else
+	{
+		mStaticScene = std::move(scene);
+	}
+	mStaticDirty = false;
+}
+
+void Graphics::CreateMesh(RenderMesh* mesh)
+{
+	assert(!mRenderThreadStopped);
+	PushCommand(RenderCommand{ RenderCommand::Type::CreateMesh, 0, mesh });
+}
+
+void Graphics::DestroyMesh(RenderMesh* mesh)
+{
+	if (mRenderThreadStopped)
+	{
+		delete mesh;
+		return;
+	}
+	PushCommand(RenderCommand{ RenderCommand::Type::DestroyMesh, 0, mesh });
+}
+
+void Graphics::StopRenderThread()
+{
+	if (mRenderThreadStopped)
+	{
+		return;
+	}
+	PushCommand(RenderCommand{ RenderCommand::Type::Stop, 0, nullptr });
+	mRenderThread.join();
+	mRenderThreadStopped = true;
+}
+
+void Graphics::PushCommand(const RenderCommand& command)
+{
+	//The queue only fills if the render thread is far behind, in which case waiting on it is the right thing anyway
+	while (!mRenderCommands.TryPush(command))
+	{
+		std::this_thread::yield();
+	}
+
+	WakeRenderThread();
+}
+
+void Graphics::WakeRenderThread()
+{
+	//Pairs with the fence in RenderLoop, either it sees what was pushed or we see it asleep
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (mRenderThreadSleeping.load(std::memory_order_relaxed))
+	{
+		{
+			std::lock_guard<std::mutex> lock(mWakeMutex);
+		}
+		mWakeCondition.notify_all();
+	}
+}
+
+void Graphics::RenderLoop()
+{
+	for (;;)
+	{
+		ResumeRenderCoroutines();
+
+		RenderCommand command;
+		if (!mRenderCommands.TryPop(command))
+		{
+			std::unique_lock<std::mutex> lock(mWakeMutex);
+			mRenderThreadSleeping.store(true, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			const auto hasWork = [this]() { return !mRenderCommands.IsEmpty() || !mRenderResumes.IsEmpty(); };
+			if (mPendingSetups.empty())
+			{
+				mWakeCondition.wait(lock, hasWork);
+			}
+			else
+			{
+				mWakeCondition.wait_for(lock, std::chrono::milliseconds(1), hasWork);
+			}
+			mRenderThreadSleeping.store(false, std::memory_order_relaxed);
+			continue;
+		}
+
+		switch (command.mType)
+		{
+		case RenderCommand::Type::DrawFrame:
+			DrawFrame(mFrames[command.mFrame]);
+			mFramesDrawn.fetch_add(1, std::memory_order_release);
+			{
+				std::lock_guard<std::mutex> lock(mWakeMutex);
+			}
+			mWakeCondition.notify_all();
+			break;
+		case RenderCommand::Type::CreateMesh:
+			command.mMesh->mResources.reset(new RenderMesh::Resources(*command.mMesh));
+			break;
+		case RenderCommand::Type::DestroyMesh:
+			mRetiredMeshes.push_back(RetiredMesh{ command.mMesh, mFramesSubmitted });
+			break;
+		case RenderCommand::Type::Stop:
+			//Nothing is submitted after this, so once the GPU drains every retired mesh can go and later DestroyMesh calls delete directly
+			hal::Render::Instance()->WaitIdle();
+			mFramesCompleted = mFramesSubmitted;
+			DeleteRetiredMeshes();
+			return;
+		}
+	}
+}
+
+void Graphics::ResumeRenderCoroutines()
 {
-	mRenderObjects.push_back(renderObject);
-	mRenderInfo.AddDrawBuffer(renderObject->GetDrawBuffer()); 
+	void* address;
+	while (mRenderResumes.TryPop(address))
+	{
+		coro::coroutine_handle<>::from_address(address).resume();
+	}
+
+	//A resumed coroutine can submit again and add to the list, so walk it by index
+	for (size_t i = 0; i < mPendingSetups.size();)
+	{
+		if (!mPendingSetups[i].mSetupBuffer->IsComplete())
+		{
+			++i;
+			continue;
+		}
+		const coro::coroutine_handle<> coroutine = mPendingSetups[i].mCoroutine;
+		mPendingSetups[i] = mPendingSetups.back();
+		mPendingSetups.pop_back();
+		coroutine.resume();
+	}
 }
 
-void Graphics::Draw()
+void Graphics::RenderThreadAwaiter::await_suspend(coro::coroutine_handle<> coroutine)
 {
-	mTransformMatracies.mViewMatrix = mMainCamera->GetView();
-	mTransformMatracies.mProjectionMatrix = mMainCamera->GetProjection();
-	for (auto renderObject : mRenderObjects)
+	while (!mGraphics->mRenderResumes.TryPush(coroutine.address()))
 	{
-		hal::DrawBuffer* drawBuffer = renderObject->GetDrawBuffer();
-		mTransformMatracies.mModelMatrix = renderObject->GetModelMatrix();
-		mMatricesBuffer->UpdateBuffer(reinterpret_cast<uint8_t*>(&mTransformMatracies));
+		std::this_thread::yield();
+	}
+	mGraphics->WakeRenderThread();
+}
 
-		drawBuffer->StartDrawBuffer();
-		hal::Render::Instance()->BeginRenderPass(*drawBuffer);
-		drawBuffer->RecordVulkanCommands(vkCmdBindDescriptorSets, VK_PIPELINE_BIND_POINT_GRAPHICS, mPipeline->GetVKPipelineLayout(), 0, 1, &mDescriptorPool->GetVKDescriptorSet(), 0, nullptr); //Pipeline placeholder?
+Task<void> Graphics::SubmitSetupAsync(std::function<void(hal::SetupCommandBuffer&)> record)
+{
+	co_await ResumeOnRenderThread();
+	{
+		//Made and freed on the render thread, the pool it comes from is the render thread's
+		hal::SetupCommandBuffer setupBuffer(mCommandPool);
+		setupBuffer.StartSetupBuffer();
+		record(setupBuffer);
+		setupBuffer.EndAndSubmitSetupBufferAsync();
+		co_await WaitForGpu(setupBuffer);
+	}
+	co_await ResumeOnJobs();
+}
+
+Task<hal::Pipeline*> Graphics::CreatePipelineAsync(hal::PipelineLayout* pipelineLayout, std::vector<const hal::ShaderInfo*> shaders)
+{
+	std::vector<std::vector<char>> shaderCode;
+	for (const hal::ShaderInfo* shader : shaders)
+	{
+		shaderCode.push_back(co_await ReadFileAsync(shader->mPath));
+	}
 
-		drawBuffer->RecordVulkanCommands(vkCmdBindPipeline, VK_PIPELINE_BIND_POINT_GRAPHICS, mPipeline->GetVKPipeline());
+	co_await ResumeOnRenderThread();
+	hal::Pipeline* pipeline = new hal::Pipeline(pipelineLayout, shaderCode);
+	co_await ResumeOnJobs();
+	co_return pipeline;
+}
 
-		drawBuffer->RecordVulkanCommands(vkCmdBindVertexBuffers, 0, 1, hal::DrawCommand::GetBufferPlaceholder(hal::BufferType::VertexBuffer, 0), mBufferOffsets);
+void Graphics::DrawFrame(RenderFrame& frame)
+{
+	const StaticScene* staticScene = frame.mStaticScene.get();
+	const uint32_t staticCount = staticScene != nullptr ? static_cast<uint32_t>(staticScene->mMeshes.size()) : 0;
+	const uint32_t drawCount = static_cast<uint32_t>(frame.mMeshes.size());
 
-		drawBuffer->RecordVulkanCommands(vkCmdBindIndexBuffer, hal::DrawCommand::GetBufferPlaceholder(hal::BufferType::IndexBuffer, 0), 0, VK_INDEX_TYPE_UINT32);
+	//Waits for the GPU to finish the frame that last had these resources, usually long done. That is the submit a full set
+	//of frames back, and every one before it. Done even with nothing on screen, the frame still has to be cleared and
+	//presented or the last image would stay up.
+	hal::Render::Instance()->BeginFrame();
+	const uint64_t framesInFlight = hal::Render::Instance()->GetFramesInFlight();
+	mFramesCompleted = mFramesSubmitted + 1 > framesInFlight ? mFramesSubmitted + 1 - framesInFlight : 0;
+	DeleteRetiredMeshes();
+	FrameUniforms& uniforms = mFrameUniforms[hal::Render::Instance()->GetCurrentFrame()];
 
-		drawBuffer->RecordVulkanCommands(vkCmdDrawIndexed, hal::DrawCommand::GetBufferLengthPlaceholder(hal::BufferType::IndexBuffer, 0), 1, 0, 0, 0);
-		hal::Render::Instance()->EndRenderPass(*drawBuffer);
-		drawBuffer->EndDrawBuffer();
+	//Blocks [0, staticCount) belong to the static objects, the visible dynamic ones follow
+	ReserveObjects(uniforms, staticCount + drawCount);
+	if (staticCount != 0)
+	{
+		UpdateStaticDraws(uniforms, *staticScene);
+	}
+	WriteObjects(uniforms, frame.mModelMatrices, staticCount);
+	uniforms.mViewProjectionBuffer->UpdateBuffer(reinterpret_cast<const uint8_t*>(&frame.mViewProjection), 0, sizeof(Matrix4));
+
+	//One render pass on one primary command buffer for the whole frame. Small frames, empty ones included, are recorded
+	//straight into it, big ones are split into chunks recorded in parallel and run in draw order.
+	const uint32_t chunkCount = (drawCount + DrawsPerRecordingChunk - 1) / DrawsPerRecordingChunk;
+	if (staticCount == 0 && chunkCount <= 1)
+	{
+		hal::DrawBuffer& drawBuffer = hal::Render::Instance()->BeginFrameRenderPass();
+		RecordDraws(drawBuffer, frame.mMeshes, 0, uniforms, 0, drawCount);
 	}
+	else
+	{
+		//The cached static draws run first, then the dynamic chunks. Each thread records from its own pool, anything that
+		//isn't a job thread gets the spare one.
+		const uint32_t firstChunk = staticCount != 0 ? 1 : 0;
+		const uint32_t threadCount = JobSystem::Instance()->GetThreadCount();
+		mRecordedChunks.resize(firstChunk + chunkCount);
+		if (staticCount != 0)
+		{
+			mRecordedChunks[0] = uniforms.mStaticDrawBuffer;
+		}
+		JobSystem::Instance()->ParallelFor(0, chunkCount, 1, [this, &frame, &uniforms, staticCount, drawCount, firstChunk, threadCount](uint32_t chunkBegin, uint32_t chunkEnd)
+		{
+			const uint32_t recordingThread = (std::min)(JobSystem::GetThreadIndex(), threadCount);
+			for (uint32_t chunk = chunkBegin; chunk < chunkEnd; ++chunk)
+			{
+				hal::DrawBuffer& drawBuffer = hal::Render::Instance()->BeginSecondaryDrawBuffer(recordingThread);
+				RecordDraws(drawBuffer, frame.mMeshes, staticCount, uniforms, chunk * DrawsPerRecordingChunk, (std::min)((chunk + 1) * DrawsPerRecordingChunk, drawCount));
+				drawBuffer.EndDrawBuffer();
+				mRecordedChunks[firstChunk + chunk] = &drawBuffer;
+			}
+		});
+
+		hal::Render::Instance()->BeginFrameRenderPass(VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+		hal::Render::Instance()->ExecuteDrawBuffers(mRecordedChunks);
+	}
+	hal::Render::Instance()->EndFrameRenderPass();
 
-	//mRenderInfo.BuildRenderinfo();
-	mRenderInfo.BuildSubmitinfo();
 	hal::Render::Instance()->Submit();
+	++mFramesSubmitted;
+}
+
+void Graphics::ReserveObjects(FrameUniforms& uniforms, uint32_t objectCount)
+{
+	if (objectCount <= uniforms.mObjectCapacity)
+	{
+		return;
+	}
+
+	//BeginFrame has waited on this frame's fence, so nothing still reads the old buffer or the set pointing at it
+	uniforms.mObjectCapacity = (std::max)(uniforms.mObjectCapacity * 2, objectCount);
+	mUniformScratch.assign(uniforms.mObjectCapacity * mUniformStride, 0);
+	delete uniforms.mMatricesBuffer;
+	uniforms.mMatricesBuffer = new hal::Buffer(uniforms.mObjectCapacity * mUniformStride, mUniformScratch.data(), hal::BufferType::UniformBuffer);
+	uniforms.mMatraciesDescriptor->SetBuffer(uniforms.mMatricesBuffer, sizeof(TransformMatracies));
+	uniforms.mDescriptorPool->WriteDescriptorSet();
+
+	//Rewriting the set invalidates anything recorded with it and the static blocks went with the old buffer
+	uniforms.mRecordedStaticVersion = 0;
+	uniforms.mWrittenStaticVersion = 0;
+}
+
+void Graphics::WriteObjects(FrameUniforms& uniforms, const std::vector<AffineTransform>& modelMatrices, uint32_t firstObject)
+{
+	const uint32_t count = static_cast<uint32_t>(modelMatrices.size());
+	if (count == 0)
+	{
+		return;
+	}
+
+	mUniformScratch.resize(count * mUniformStride);
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		TransformMatracies* block = reinterpret_cast<TransformMatracies*>(mUniformScratch.data() + i * mUniformStride);
+		block->mModelMatrix = modelMatrices[i];
+	}
+	uniforms.mMatricesBuffer->UpdateBuffer(mUniformScratch.data(), firstObject * mUniformStride, count * mUniformStride);
+}
+
+void Graphics::UpdateStaticDraws(FrameUniforms& uniforms, const StaticScene& scene)
+{
+	//The blocks only hold model matrices, so the camera moving leaves them alone
+	if (uniforms.mWrittenStaticVersion != scene.mVersion)
+	{
+		WriteObjects(uniforms, scene.mModelMatrices, 0);
+		uniforms.mWrittenStaticVersion = scene.mVersion;
+	}
+
+	const uint32_t swapchainGeneration = hal::Render::Instance()->GetSwapchainGeneration();
+	if (uniforms.mRecordedStaticVersion == scene.mVersion && uniforms.mRecordedPipeline == mPipeline && uniforms.mRecordedSwapchainGeneration == swapchainGeneration)
+	{
+		return;
+	}
+
+	//This frame's fence has signalled, so the GPU is done with the last recording and it can be started over
+	if (uniforms.mStaticDrawBuffer == nullptr)
+	{
+		uniforms.mStaticDrawBuffer = new hal::DrawBuffer(mCommandPool, {}, VK_COMMAND_BUFFER_LEVEL_SECONDARY);
+	}
+	hal::Render::Instance()->BeginCachedDrawBuffer(*uniforms.mStaticDrawBuffer);
+	RecordDraws(*uniforms.mStaticDrawBuffer, scene.mMeshes, 0, uniforms, 0, static_cast<uint32_t>(scene.mMeshes.size()));
+	uniforms.mStaticDrawBuffer->EndDrawBuffer();
+
+	uniforms.mRecordedStaticVersion = scene.mVersion;
+	uniforms.mRecordedPipeline = mPipeline;
+	uniforms.mRecordedSwapchainGeneration = swapchainGeneration;
+}
+
+void Graphics::RecordDraws(hal::DrawBuffer& drawBuffer, const std::vector<RenderMesh*>& meshes, uint32_t firstObject, const FrameUniforms& uniforms, uint32_t begin, uint32_t end) const
+{
+	//Everything drawn shares the pipeline and descriptor set, each object only costs its set offset, buffer binds and draw
+	drawBuffer.RecordCommand(vkCmdBindPipeline, VK_PIPELINE_BIND_POINT_GRAPHICS, mPipeline->GetVKPipeline());
+	for (uint32_t i = begin; i < end; ++i)
+	{
+		const hal::DrawInfo& drawInfo = meshes[i]->mResources->mDrawInfo;
+		const uint32_t uniformOffset = (firstObject + i) * mUniformStride;
+
+		drawBuffer.RecordCommand(vkCmdBindDescriptorSets, VK_PIPELINE_BIND_POINT_GRAPHICS, mPipeline->GetVKPipelineLayout(), 0, 1, &uniforms.mDescriptorPool->GetVKDescriptorSet(), 1, &uniformOffset);
+
+		drawBuffer.RecordDrawInfoCommand(drawInfo, vkCmdBindVertexBuffers, 0, 1, hal::DrawCommand::GetBufferPlaceholder(hal::BufferType::VertexBuffer, 0), mBufferOffsets);
+
+		drawBuffer.RecordDrawInfoCommand(drawInfo, vkCmdBindIndexBuffer, hal::DrawCommand::GetBufferPlaceholder(hal::BufferType::IndexBuffer, 0), 0, VK_INDEX_TYPE_UINT32);
+
+		drawBuffer.RecordDrawInfoCommand(drawInfo, vkCmdDrawIndexed, hal::DrawCommand::GetBufferLengthPlaceholder(hal::BufferType::IndexBuffer, 0), 1, 0, 0, 0);
+	}
+}
+
+void Graphics::DeleteRetiredMeshes()
+{
+	//mFramesCompleted only counts submits whose fence has been waited on
+	for (size_t i = 0; i < mRetiredMeshes.size();)
+	{
+		if (mRetiredMeshes[i].mLastFrame > mFramesCompleted)
+		{
+			++i;
+			continue;
+		}
+		delete mRetiredMeshes[i].mMesh;
+		mRetiredMeshes[i] = mRetiredMeshes.back();
+		mRetiredMeshes.pop_back();
+	}
 }
 
 Graphics::~Graphics()
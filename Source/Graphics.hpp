@@ -1,21 +1,30 @@
 #pragma once
 #include <halcyonic_renderer.hpp>
 #include "Matrix4.hpp"
+#include "AffineTransform.hpp"
+#include "TransformStore.hpp"
+#include "ConcurrentQueue.hpp"
+#include "Task.hpp"
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
 
 class Camera;
-class RenderObject;
+struct RenderMesh;
 class Graphics;
 typedef std::unique_ptr<Graphics> graphics_ptr;
 class Graphics
 {
 private:
 	static graphics_ptr s_Instance;
-	struct TransformMatracies
+	struct TransformMatracies //Matches the std140 layout of ObjectBlock in vertex.vert, one per object drawn
 	{
-		Matrix4 mModelMatrix;
-		Matrix4 mViewMatrix;
-		Matrix4 mProjectionMatrix;
-	} mTransformMatracies; //These should really be in seperate ubos
+		AffineTransform mModelMatrix;
+	}; //The view-projection is in FrameBlock, once per frame
 
 	hal::RenderLayout mRenderLayout;
 	hal::CommandPool* mCommandPool;
@@ -31,34 +40,194 @@ private:
 	hal::ShaderInputLayout* mShaderInputLayout;
 	std::vector<const hal::ShaderInfo*> mShaderInfos;
 	hal::PipelineLayout* mPipelineLayout;
-	hal::Buffer* mMatricesBuffer;
-	hal::BufferDescriptor* mMatraciesDescriptor;
-	std::vector<const hal::Descriptor*> mPipelineDescriptors;
-	hal::DescriptorPool* mDescriptorPool;
+	//Uniform memory for each frame in flight, so the CPU never writes what the GPU may still be reading. mMatricesBuffer
+	//holds a TransformMatracies block per object, each draw binds the set at its object's offset. Static objects come first.
+	struct FrameUniforms
+	{
+		hal::Buffer* mMatricesBuffer;
+		hal::BufferDescriptor* mMatraciesDescriptor;
+		hal::Buffer* mViewProjectionBuffer;
+		hal::BufferDescriptor* mViewProjectionDescriptor;
+		std::vector<const hal::Descriptor*> mPipelineDescriptors;
+		hal::DescriptorPool* mDescriptorPool;
+		uint32_t mObjectCapacity;
+
+		//The static draws, recorded once from mCommandPool and executed every time this frame comes round until the
+		//static objects, the pipeline, the descriptor set or the swapchain change. 0 versions mean not done yet.
+		hal::DrawBuffer* mStaticDrawBuffer = nullptr;
+		uint64_t mRecordedStaticVersion = 0;
+		const hal::Pipeline* mRecordedPipeline = nullptr;
+		uint32_t mRecordedSwapchainGeneration = 0;
+		uint64_t mWrittenStaticVersion = 0;
+	};
+	std::vector<FrameUniforms> mFrameUniforms;
 	hal::Pipeline* mPipeline;
-	hal::RenderInfo mRenderInfo;
+
+	static constexpr uint32_t InitialObjectCapacity = 64;
+	uint32_t mUniformStride; //sizeof(TransformMatracies) rounded up to the device's dynamic offset alignment
+	std::vector<uint8_t> mUniformScratch; //Render thread, blocks are laid out here and copied up in one go
 
 	VkDeviceSize mBufferOffsets[1] = { 0 };
 
-	std::vector<RenderObject*> mRenderObjects;
+	//Frames with more draws than this are split into chunks of it, recorded on the job threads into secondary buffers
+	static constexpr uint32_t DrawsPerRecordingChunk = 256;
+	std::vector<const hal::DrawBuffer*> mRecordedChunks; //Render thread, in draw order
+
+	struct CullingStreams //Object bounds laid out for Frustum::CullSpheres, rebuilt from the EntityWorld every frame
+	{
+		std::vector<float> mCenterX;
+		std::vector<float> mCenterY;
+		std::vector<float> mCenterZ;
+		std::vector<float> mRadius;
+		std::vector<TransformHandle> mTransforms;
+		std::vector<RenderMesh*> mMeshes;
+		std::vector<uint32_t> mVisibleObjects;
+	} mCulling; //Only touched by the game thread
+
+	//Every static object as of the last MarkStaticDirty. Never written once built, the game thread makes a new one with a
+	//new version instead, so any number of queued frames can share it.
+	struct StaticScene
+	{
+		uint64_t mVersion;
+		std::vector<AffineTransform> mModelMatrices;
+		std::vector<RenderMesh*> mMeshes;
+	};
+	std::shared_ptr<const StaticScene> mStaticScene; //Game thread, null while there are no static objects
+	uint64_t mStaticVersion = 0;
+	bool mStaticDirty = false;
+
+	//Everything the render thread needs to draw one frame. The game thread fills one while the render thread draws the
+	//other, so neither ever reads what the other is writing.
+	struct RenderFrame
+	{
+		Matrix4 mViewProjection;
+		std::vector<AffineTransform> mModelMatrices;
+		std::vector<RenderMesh*> mMeshes;
+		std::shared_ptr<const StaticScene> mStaticScene;
+	} mFrames[2];
+
+	//Render thread. Destroyed meshes wait here until no frame still on the GPU can be drawing them.
+	struct RetiredMesh
+	{
+		RenderMesh* mMesh;
+		uint64_t mLastFrame; //Submits before this one may use the mesh
+	};
+	std::vector<RetiredMesh> mRetiredMeshes;
+	uint64_t mFramesSubmitted = 0;
+	uint64_t mFramesCompleted = 0; //Submits the GPU is known to be done with, as of the last BeginFrame or Stop
+
+	//All the game thread ever asks of the render thread. Handled strictly in order, so a mesh created before a frame is
+	//ready by the time that frame is drawn and one destroyed after it lives until the frame is done with it.
+	struct RenderCommand
+	{
+		enum class Type : uint32_t
+		{
+			DrawFrame,
+			CreateMesh,
+			DestroyMesh,
+			Stop
+		};
+		Type mType;
+		uint32_t mFrame;
+		RenderMesh* mMesh;
+	};
+	SPSCQueue<RenderCommand, 256> mRenderCommands;
+	std::thread mRenderThread;
+	uint64_t mFramesIssued = 0; //Game thread
+	std::atomic<uint64_t> mFramesDrawn;
+	bool mRenderThreadStopped = false; //Game thread
+
+	//Only used to sleep, the render thread when the queue is empty and the game thread when it gets a frame ahead
+	std::mutex mWakeMutex;
+	std::condition_variable mWakeCondition;
+	std::atomic<bool> mRenderThreadSleeping;
+
+	//Coroutines waiting to carry on from the render thread, pushed from any thread and resumed between commands
+	MPMCQueue<void*, 256> mRenderResumes;
+	//Render thread. Setup submits still on the GPU, each with the coroutine to resume once it is done. Fences can't wake
+	//the render thread, so it polls these while any are left.
+	struct PendingSetup
+	{
+		const hal::SetupCommandBuffer* mSetupBuffer;
+		coro::coroutine_handle<> mCoroutine;
+	};
+	std::vector<PendingSetup> mPendingSetups;
 
 	Camera* mMainCamera;
 
 	Graphics();
+	//Everything that used to be in the constructor, run on the render thread so it owns the queue and swapchain
+	void InitializeRender();
+	void RenderLoop();
+	void PushCommand(const RenderCommand& command);
+	void WakeRenderThread();
+	void ResumeRenderCoroutines();
+	void DrawFrame(RenderFrame& frame);
+	//Game thread
+	void RebuildStaticScene();
+	//Render thread, after BeginFrame. Grows the frame's uniform buffer to hold objectCount blocks.
+	void ReserveObjects(FrameUniforms& uniforms, uint32_t objectCount);
+	//Render thread. Writes a block per model matrix starting at block firstObject.
+	void WriteObjects(FrameUniforms& uniforms, const std::vector<AffineTransform>& modelMatrices, uint32_t firstObject);
+	//Render thread. Rewrites the static blocks and re-records the static draws only if something they use has changed.
+	void UpdateStaticDraws(FrameUniforms& uniforms, const StaticScene& scene);
+	//Binds the pipeline, then records the draws of meshes in [begin, end), mesh i reading block firstObject + i. Safe on
+	//any thread.
+	void RecordDraws(hal::DrawBuffer& drawBuffer, const std::vector<RenderMesh*>& meshes, uint32_t firstObject, const FrameUniforms& uniforms, uint32_t begin, uint32_t end) const;
+	void DeleteRetiredMeshes();
 public:
 	static void CreateInstance();
 	static const graphics_ptr& Instance();
 	static void DestroyInstance();
 
+	struct RenderThreadAwaiter
+	{
+		Graphics* mGraphics;
+		bool await_ready() const noexcept { return false; }
+		void await_suspend(coro::coroutine_handle<> coroutine);
+		void await_resume() noexcept {}
+	};
+	struct GpuAwaiter
+	{
+		Graphics* mGraphics;
+		const hal::SetupCommandBuffer* mSetupBuffer;
+		bool await_ready() const { return mSetupBuffer->IsComplete(); }
+		void await_suspend(coro::coroutine_handle<> coroutine) { mGraphics->mPendingSetups.push_back(PendingSetup{ mSetupBuffer, coroutine }); }
+		void await_resume() noexcept {}
+	};
+
 	const hal::Pipeline* GetPipeline() const { return mPipeline; }
 	const hal::CommandPool* GetCommandPool() const { return mCommandPool; }
 	Camera& GetMainCamera() const { return *mMainCamera; }
 
-	void AddRenderObject(RenderObject* renderObject); //OOF
 	void SetMainCamera(Camera* mainCamera) { mMainCamera = mainCamera; }
+	//Game thread. A static object was added, moved or removed, the next Draw rebuilds the static draws.
+	void MarkStaticDirty() { mStaticDirty = true; }
+
+	//Game thread. Culls against the main camera, fills in the next frame and queues it for the render thread. Only waits
+	//if the render thread is still on the previous frame, so the game runs at most one frame ahead of the GPU submit.
+	//Objects are drawn alpha of the way from where the last simulation step started to where it ended.
+	//A frame is queued even when culling leaves nothing visible, the screen still has to be cleared and presented.
+	void Draw(float alpha = 1.0f);
+	//Game thread. The render thread builds the mesh's Vulkan resources before it draws another frame.
+	void CreateMesh(RenderMesh* mesh);
+	//Game thread. Takes ownership, the render thread deletes it once the GPU is done with every frame queued so far.
+	void DestroyMesh(RenderMesh* mesh);
+	//Submits what is queued and joins the render thread, Draw can't be called after
+	void StopRenderThread();
 
-	void RebuildRenderInfo() { mRenderInfo.BuildRenderinfo(); }
-	void Draw();
+	//co_await Graphics::Instance()->ResumeOnRenderThread() carries on from the render thread between commands, where the
+	//queue and command pool can be used. From any thread. Anything still waiting when the render thread stops never resumes.
+	RenderThreadAwaiter ResumeOnRenderThread() { return RenderThreadAwaiter{ this }; }
+	//Render thread. After setupBuffer.EndAndSubmitSetupBufferAsync(), carries on from the render thread once the GPU has
+	//finished with it. The render thread keeps drawing in the meantime.
+	GpuAwaiter WaitForGpu(const hal::SetupCommandBuffer& setupBuffer) { return GpuAwaiter{ this, &setupBuffer }; }
+	//Records setup commands with record on the render thread and submits them, carries on from a job thread once the GPU
+	//has run them. Nothing blocks on the GPU along the way.
+	Task<void> SubmitSetupAsync(std::function<void(hal::SetupCommandBuffer&)> record);
+	//Reads the shaders on job threads, in layout order, then builds the pipeline on the render thread. Carries on from a
+	//job thread.
+	Task<hal::Pipeline*> CreatePipelineAsync(hal::PipelineLayout* pipelineLayout, std::vector<const hal::ShaderInfo*> shaders);
 
 	~Graphics();
 };
\ No newline at end of file
@@ -0,0 +1,121 @@
+#include "precompiled.hpp"
+#include "MathSIMD.hpp"
+#include "Half.hpp"
+
+#include <cstring>
+
+uint16_t Half::FloatToBits(float value)
+{
+	uint32_t floatBits;
+	memcpy(&floatBits, &value, sizeof(floatBits));
+	const uint32_t sign = (floatBits >> 16) & 0x8000u;
+	const uint32_t magnitude = floatBits & 0x7fffffffu;
+
+	if (magnitude >= 0x7f800000u)
+	{
+		//Inf stays inf, NaN keeps its top payload bits and is forced quiet so it can't collapse into inf
+		const uint32_t nan = magnitude > 0x7f800000u ? 0x200u | ((magnitude >> 13) & 0x3ffu) : 0u;
+		return static_cast<uint16_t>(sign | 0x7c00u | nan);
+	}
+	//65520 is the halfway point between 65504 and inf, it and everything above round up to inf
+	if (magnitude >= 0x477ff000u)
+	{
+		return static_cast<uint16_t>(sign | 0x7c00u);
+	}
+	//Below 2^-14 the result is denormal, anything at or below 2^-25 rounds to zero
+	if (magnitude < 0x38800000u)
+	{
+		if (magnitude <= 0x33000000u)
+		{
+			return static_cast<uint16_t>(sign);
+		}
+		const uint32_t shift = 126u - (magnitude >> 23);
+		const uint32_t mantissa = (magnitude & 0x7fffffu) | 0x800000u;
+		uint32_t result = mantissa >> shift;
+		const uint32_t remainder = mantissa & ((1u << shift) - 1u);
+		const uint32_t halfway = 1u << (shift - 1u);
+		if (remainder > halfway || (remainder == halfway && (result & 1u)))
+		{
+			++result;
+		}
+		return static_cast<uint16_t>(sign | result);
+	}
+
+	//Rebias the exponent from 127 to 15, a mantissa carry rolls into the exponent which is what we want
+	uint32_t result = (magnitude - 0x38000000u) >> 13;
+	const uint32_t remainder = magnitude & 0x1fffu;
+	if (remainder > 0x1000u || (remainder == 0x1000u && (result & 1u)))
+	{
+		++result;
+	}
+	return static_cast<uint16_t>(sign | result);
+}
+
+float Half::BitsToFloat(uint16_t inBits)
+{
+	const uint32_t sign = static_cast<uint32_t>(inBits & 0x8000u) << 16;
+	uint32_t exponent = (inBits >> 10) & 0x1fu;
+	uint32_t mantissa = inBits & 0x3ffu;
+	uint32_t floatBits;
+
+	if (exponent == 0x1fu)
+	{
+		//Quiet any NaN on the way up, same as vcvtph2ps
+		floatBits = sign | 0x7f800000u | ((mantissa != 0u ? mantissa | 0x200u : 0u) << 13);
+	}
+	else if (exponent != 0u)
+	{
+		floatBits = sign | ((exponent + 112u) << 23) | (mantissa << 13);
+	}
+	else if (mantissa == 0u)
+	{
+		floatBits = sign;
+	}
+	else
+	{
+		//Denormal half, every one of them is a normal float once the leading bit is shifted up
+		exponent = 113u;
+		while (!(mantissa & 0x400u))
+		{
+			mantissa <<= 1;
+			--exponent;
+		}
+		floatBits = sign | (exponent << 23) | ((mantissa & 0x3ffu) << 13);
+	}
+
+	float value;
+	memcpy(&value, &floatBits, sizeof(value));
+	return value;
+}
+
+void Half::ToHalfBatch(const float* in, Half* out, size_t count)
+{
+	size_t i = 0;
+#if defined(MATH_SIMD_F16C)
+	for (; i + 8 <= count; i += 8)
+	{
+		const __m128i packed = _mm256_cvtps_ph(_mm256_loadu_ps(in + i), _MM_FROUND_TO_NEAREST_INT);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), packed);
+	}
+#endif
+	for (; i < count; ++i)
+	{
+		out[i].bits = FloatToBits(in[i]);
+	}
+}
+
+void Half::ToFloatBatch(const Half* in, float* out, size_t count)
+{
+	size_t i = 0;
+#if defined(MATH_SIMD_F16C)
+	for (; i + 8 <= count; i += 8)
+	{
+		const __m128i packed = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+		_mm256_storeu_ps(out + i, _mm256_cvtph_ps(packed));
+	}
+#endif
+	for (; i < count; ++i)
+	{
+		out[i] = BitsToFloat(in[i].bits);
+	}
+}
\ No newline at end of file
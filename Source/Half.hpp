@@ -0,0 +1,54 @@
+#pragma once
+#include "Vector3.hpp"
+#include "Vector4.hpp"
+
+//IEEE 754 binary16 for storage only, widen to float before doing any math. Conversion rounds to nearest even and keeps
+//inf, NaN and denormals. Largest finite value is 65504, relative precision is about 4.9e-4.
+class Half
+{
+public:
+	uint16_t bits;
+
+	Half() {}
+	explicit Half(float value) : bits(FloatToBits(value)) {}
+	static constexpr Half FromBits(uint16_t inBits) { return Half(inBits, 0); }
+	operator float() const { return BitsToFloat(bits); }
+
+	static uint16_t FloatToBits(float value);
+	static float BitsToFloat(uint16_t inBits);
+
+	//Uses F16C eight at a time when MATH_SIMD_F16C is defined
+	static void ToHalfBatch(const float* in, Half* out, size_t count);
+	static void ToFloatBatch(const Half* in, float* out, size_t count);
+
+private:
+	constexpr Half(uint16_t inBits, int) : bits(inBits) {}
+};
+
+class Half2
+{
+public:
+	Half x;
+	Half y;
+
+	Half2() {}
+	Half2(float inX, float inY) : x(inX), y(inY) {}
+};
+
+class Half4
+{
+public:
+	Half x;
+	Half y;
+	Half z;
+	Half w;
+
+	Half4() {}
+	Half4(float inX, float inY, float inZ, float inW) : x(inX), y(inY), z(inZ), w(inW) {}
+	Half4(const Vector3& vec, float inW) : x(vec.x), y(vec.y), z(vec.z), w(inW) {}
+	explicit Half4(const Vector4& vec) : x(vec.x), y(vec.y), z(vec.z), w(vec.w) {}
+	Vector3 ToVector3() const { return Vector3(x, y, z); }
+	Vector4 ToVector4() const { return Vector4(x, y, z, w); }
+};
+
+static_assert(sizeof(Half) == 2 && sizeof(Half2) == 4 && sizeof(Half4) == 8, "Half types must match the GPU's 16 bit formats");
\ No newline at end of file
@@ -0,0 +1,317 @@
+#include "precompiled.hpp"
+#include "JobSystem.hpp"
+
+job_system_ptr JobSystem::s_Instance = nullptr;
+thread_local uint32_t JobSystem::s_ThreadIndex = JobSystem::InvalidThread;
+
+JobDeque::JobDeque() :
+	mTop(0),
+	mBottom(0)
+{
+	for (auto& job : mJobs)
+	{
+		job.store(nullptr, std::memory_order_relaxed);
+	}
+}
+
+bool JobDeque::Push(Job* job)
+{
+	const int64_t bottom = mBottom.load(std::memory_order_relaxed);
+	const int64_t top = mTop.load(std::memory_order_acquire);
+	if (bottom - top >= Capacity)
+	{
+		return false;
+	}
+	mJobs[bottom & (Capacity - 1)].store(job, std::memory_order_relaxed);
+	//Release pairs with the acquire in Steal, a thief that sees the new bottom also sees the job and what it points at
+	mBottom.store(bottom + 1, std::memory_order_release);
+	return true;
+}
+
+Job* JobDeque::Pop()
+{
+	const int64_t bottom = mBottom.load(std::memory_order_relaxed) - 1;
+	mBottom.store(bottom, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	int64_t top = mTop.load(std::memory_order_relaxed);
+	if (top > bottom)
+	{
+		mBottom.store(bottom + 1, std::memory_order_relaxed);
+		return nullptr;
+	}
+
+	Job* job = mJobs[bottom & (Capacity - 1)].load(std::memory_order_relaxed);
+	if (top == bottom)
+	{
+		//Last job, race the thieves for it
+		if (!mTop.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+		{
+			job = nullptr;
+		}
+		mBottom.store(bottom + 1, std::memory_order_relaxed);
+	}
+	return job;
+}
+
+Job* JobDeque::Steal()
+{
+	int64_t top = mTop.load(std::memory_order_acquire);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	const int64_t bottom = mBottom.load(std::memory_order_acquire);
+	if (top >= bottom)
+	{
+		return nullptr;
+	}
+
+	Job* job = mJobs[top & (Capacity - 1)].load(std::memory_order_relaxed);
+	if (!mTop.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+	{
+		return nullptr;
+	}
+	return job;
+}
+
+JobSystem::JobSystem(uint32_t workerCount) :
+	mQueuedJobs(0),
+	mSleepingWorkers(0),
+	mShutdown(false)
+{
+	s_ThreadIndex = 0;
+	for (uint32_t i = 0; i <= workerCount; ++i)
+	{
+		mDeques.emplace_back(new JobDeque());
+	}
+	for (uint32_t i = 1; i <= workerCount; ++i)
+	{
+		mWorkers.emplace_back(&JobSystem::WorkerLoop, this, i);
+	}
+}
+
+void JobSystem::CreateInstance(uint32_t workerCount)
+{
+	if (s_Instance == nullptr)
+	{
+		if (workerCount == 0)
+		{
+			workerCount = (std::max)(std::thread::hardware_concurrency(), 2u) - 1;
+		}
+		s_Instance = static_cast<job_system_ptr>(new JobSystem(workerCount));
+	}
+}
+
+const job_system_ptr & JobSystem::Instance()
+{
+	assert(s_Instance != nullptr);
+	return s_Instance;
+}
+
+void JobSystem::DestroyInstance()
+{
+	s_Instance.reset();
+}
+
+JobSystem::~JobSystem()
+{
+	{
+		std::lock_guard<std::mutex> lock(mWakeMutex);
+		mShutdown.store(true);
+	}
+	mWakeCondition.notify_all();
+	for (auto& worker : mWorkers)
+	{
+		worker.join();
+	}
+}
+
+void JobSystem::WorkerLoop(uint32_t threadIndex)
+{
+	s_ThreadIndex = threadIndex;
+	while (!mShutdown.load(std::memory_order_relaxed))
+	{
+		Job* job = TakeJob();
+		if (job != nullptr)
+		{
+			Execute(job);
+			continue;
+		}
+
+		//Spin a little before sleeping, most gaps between batches of jobs are short
+		for (uint32_t spin = 0; spin < 64 && mQueuedJobs.load(std::memory_order_relaxed) == 0; ++spin)
+		{
+			std::this_thread::yield();
+		}
+		if (mQueuedJobs.load(std::memory_order_seq_cst) != 0)
+		{
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(mWakeMutex);
+		mSleepingWorkers.fetch_add(1, std::memory_order_seq_cst);
+		mWakeCondition.wait(lock, [this]() { return mQueuedJobs.load(std::memory_order_seq_cst) != 0 || mShutdown.load(); });
+		mSleepingWorkers.fetch_sub(1, std::memory_order_relaxed);
+	}
+}
+
+void JobSystem::Queue(Job* const* jobs, uint32_t count)
+{
+	//Each job is counted before it is pushed, a thief could otherwise take it and count it off first and wrap the count
+	uint32_t queued = 0;
+	if (s_ThreadIndex < mDeques.size())
+	{
+		JobDeque& deque = *mDeques[s_ThreadIndex];
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			mQueuedJobs.fetch_add(1, std::memory_order_seq_cst);
+			if (deque.Push(jobs[i]))
+			{
+				++queued;
+			}
+			else
+			{
+				mQueuedJobs.fetch_sub(1, std::memory_order_relaxed);
+				Execute(jobs[i]);
+			}
+		}
+	}
+	else
+	{
+		//Not a job thread, so no deque of its own. Running the job here instead would be on the wrong thread, so wait out
+		//a full queue.
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			mQueuedJobs.fetch_add(1, std::memory_order_seq_cst);
+			while (!mExternalJobs.TryPush(jobs[i]))
+			{
+				std::this_thread::yield();
+			}
+			++queued;
+		}
+	}
+
+	//Taking the lock orders the notify after any worker that is between its check and its wait
+	if (queued != 0 && mSleepingWorkers.load(std::memory_order_seq_cst) != 0)
+	{
+		{
+			std::lock_guard<std::mutex> lock(mWakeMutex);
+		}
+		if (queued == 1)
+		{
+			mWakeCondition.notify_one();
+		}
+		else
+		{
+			mWakeCondition.notify_all();
+		}
+	}
+}
+
+Job* JobSystem::TakeJob()
+{
+	const uint32_t self = s_ThreadIndex;
+	const uint32_t threadCount = GetThreadCount();
+	Job* job = mDeques[self]->Pop();
+	if (job == nullptr)
+	{
+		mExternalJobs.TryPop(job);
+	}
+	for (uint32_t i = 1; job == nullptr && i < threadCount; ++i)
+	{
+		job = mDeques[(self + i) % threadCount]->Steal();
+	}
+	if (job != nullptr)
+	{
+		mQueuedJobs.fetch_sub(1, std::memory_order_relaxed);
+	}
+	return job;
+}
+
+void JobSystem::Execute(Job* job)
+{
+	JobCounter* counter = job->mCounter;
+	job->mFunction(job->mData);
+	if (counter != nullptr)
+	{
+		Finished(*counter);
+	}
+}
+
+void JobSystem::Finished(JobCounter& counter)
+{
+	std::vector<Job*> continuations;
+	counter.mFinishing.fetch_add(1, std::memory_order_seq_cst);
+	if (counter.mValue.fetch_sub(1, std::memory_order_seq_cst) == 1)
+	{
+		std::lock_guard<std::mutex> lock(counter.mContinuationMutex);
+		continuations.swap(counter.mContinuations);
+	}
+	//Last touch of the counter, the owner is free to destroy it from here on
+	counter.mFinishing.fetch_sub(1, std::memory_order_seq_cst);
+
+	if (!continuations.empty())
+	{
+		Queue(continuations.data(), static_cast<uint32_t>(continuations.size()));
+	}
+}
+
+void JobSystem::Schedule(Job& job)
+{
+	job.mCounter = nullptr;
+	Job* jobs[1] = { &job };
+	Queue(jobs, 1);
+}
+
+void JobSystem::Run(Job* const* jobs, uint32_t count, JobCounter& counter)
+{
+	counter.mValue.fetch_add(count, std::memory_order_relaxed);
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		jobs[i]->mCounter = &counter;
+	}
+	Queue(jobs, count);
+}
+
+void JobSystem::RunAfter(JobCounter& dependency, Job* const* jobs, uint32_t count, JobCounter& counter)
+{
+	counter.mValue.fetch_add(count, std::memory_order_relaxed);
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		jobs[i]->mCounter = &counter;
+	}
+
+	{
+		//Finished swaps the list out under this lock after the count hits zero, so either it sees these jobs or we see zero
+		std::lock_guard<std::mutex> lock(dependency.mContinuationMutex);
+		if (dependency.mValue.load(std::memory_order_seq_cst) != 0)
+		{
+			dependency.mContinuations.insert(dependency.mContinuations.end(), jobs, jobs + count);
+			return;
+		}
+	}
+	Queue(jobs, count);
+}
+
+void JobSystem::Wait(JobCounter& counter)
+{
+	//Not a job thread, so no deque of its own and nothing it may run. It just waits for the job threads.
+	if (s_ThreadIndex >= mDeques.size())
+	{
+		while (!counter.IsDone())
+		{
+			std::this_thread::yield();
+		}
+		return;
+	}
+
+	while (!counter.IsDone())
+	{
+		Job* job = TakeJob();
+		if (job != nullptr)
+		{
+			Execute(job);
+		}
+		else
+		{
+			std::this_thread::yield();
+		}
+	}
+}
\ No newline at end of file
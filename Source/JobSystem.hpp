@@ -0,0 +1,202 @@
+#pragma once
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <algorithm>
+#include <cassert>
+#include "ConcurrentQueue.hpp"
+
+typedef void(*JobFunction)(void* data);
+class JobCounter;
+
+//Jobs are not copied, the deques hold pointers, so a job has to outlive its counter reaching zero
+struct Job
+{
+	JobFunction mFunction = nullptr;
+	void* mData = nullptr;
+	JobCounter* mCounter = nullptr;
+};
+
+//Counts jobs still to finish. JobSystem::Run adds to it, each job takes one off when it ends. Jobs queued with RunAfter
+//are held here until it reaches zero.
+class JobCounter
+{
+private:
+	friend class JobSystem;
+	std::atomic<uint32_t> mValue;
+	//Held above zero while a finishing job still touches the counter, so a waiter can't see it done and destroy it early
+	std::atomic<uint32_t> mFinishing;
+	std::mutex mContinuationMutex;
+	std::vector<Job*> mContinuations;
+public:
+	JobCounter() : mValue(0), mFinishing(0) {}
+	JobCounter(const JobCounter&) = delete;
+	JobCounter& operator=(const JobCounter&) = delete;
+
+	bool IsDone() const { return mValue.load(std::memory_order_seq_cst) == 0 && mFinishing.load(std::memory_order_seq_cst) == 0; }
+};
+
+//Chase-Lev deque. Only the owning thread pushes and pops the bottom, any thread may steal from the top.
+class JobDeque
+{
+public:
+	static constexpr int64_t Capacity = 4096;
+
+	JobDeque();
+	//False when full, the caller runs the job itself instead
+	bool Push(Job* job);
+	Job* Pop();
+	Job* Steal();
+
+private:
+	alignas(64) std::atomic<int64_t> mTop;
+	alignas(64) std::atomic<int64_t> mBottom;
+	alignas(64) std::atomic<Job*> mJobs[Capacity];
+};
+
+class JobSystem;
+typedef std::unique_ptr<JobSystem> job_system_ptr;
+//One worker per core besides the thread that calls CreateInstance, which is thread 0 and runs jobs whenever it waits.
+//Each thread pushes to its own deque and idle threads steal from the others.
+class JobSystem
+{
+private:
+	static job_system_ptr s_Instance;
+	static constexpr uint32_t InvalidThread = 0xffffffffu;
+	static thread_local uint32_t s_ThreadIndex;
+
+	std::vector<std::unique_ptr<JobDeque>> mDeques;
+	std::vector<std::thread> mWorkers;
+	//Jobs queued from threads that aren't job threads, like the render thread, taken before anything is stolen
+	MPMCQueue<Job*, 1024> mExternalJobs;
+
+	//Sleeping workers are woken when jobs are queued, the two atomics close the gap between checking and sleeping
+	std::mutex mWakeMutex;
+	std::condition_variable mWakeCondition;
+	std::atomic<uint32_t> mQueuedJobs;
+	std::atomic<uint32_t> mSleepingWorkers;
+	std::atomic<bool> mShutdown;
+
+	explicit JobSystem(uint32_t workerCount);
+	void WorkerLoop(uint32_t threadIndex);
+	void Queue(Job* const* jobs, uint32_t count);
+	Job* TakeJob();
+	void Execute(Job* job);
+	void Finished(JobCounter& counter);
+
+	template<typename Function>
+	struct ParallelForState
+	{
+		Function* mFunction;
+		std::atomic<uint64_t> mNext;
+		uint64_t mEnd;
+		uint64_t mGrainSize;
+	};
+public:
+	//workerCount 0 starts one worker per hardware thread, less the calling thread
+	static void CreateInstance(uint32_t workerCount = 0);
+	static const job_system_ptr& Instance();
+	static void DestroyInstance();
+	~JobSystem();
+
+	uint32_t GetThreadCount() const { return static_cast<uint32_t>(mDeques.size()); }
+	//0 on the thread that created the system, 1 to GetThreadCount() - 1 on the workers. Only these threads run jobs, any
+	//other thread that waits on them only yields until the job threads are done.
+	static uint32_t GetThreadIndex() { return s_ThreadIndex; }
+	//Jobs waiting for a thread, not counting ones already running
+	uint32_t GetQueuedJobCount() const { return mQueuedJobs.load(std::memory_order_relaxed); }
+
+	void Run(Job* const* jobs, uint32_t count, JobCounter& counter);
+	void Run(Job& job, JobCounter& counter) { Job* jobs[1] = { &job }; Run(jobs, 1, counter); }
+	//Queues a job nothing waits on. Unlike the rest this is safe from any thread, which is how work gets handed back from
+	//the render thread.
+	void Schedule(Job& job);
+	//Counts something that isn't a job against counter, so Wait and RunAfter treat it like one until Release is called.
+	//Lets a coroutine or a GPU fence hold up jobs the same way a job would.
+	void Hold(JobCounter& counter) { counter.mValue.fetch_add(1, std::memory_order_relaxed); }
+	void Release(JobCounter& counter) { Finished(counter); }
+	//counter goes up straight away but the jobs are only queued once dependency reaches zero
+	void RunAfter(JobCounter& dependency, Job* const* jobs, uint32_t count, JobCounter& counter);
+	//Runs queued jobs on this thread until counter reaches zero. From a thread that isn't a job thread, like the render
+	//thread, it only yields until then.
+	void Wait(JobCounter& counter);
+
+	//Calls function(rangeBegin, rangeEnd) over [begin, end) in grainSize pieces spread over every thread, returns when
+	//all of them are done. Pieces are handed out from a shared cursor so fast threads simply take more of them. Pieces
+	//only ever run on job threads, even a single one asked for from outside them.
+	template<typename Function>
+	void ParallelFor(uint32_t begin, uint32_t end, uint32_t grainSize, Function&& function)
+	{
+		if (begin >= end)
+		{
+			return;
+		}
+		grainSize = (std::max)(grainSize, 1u);
+		const uint64_t pieces = (static_cast<uint64_t>(end - begin) + grainSize - 1) / grainSize;
+		if (pieces == 1 && s_ThreadIndex < GetThreadCount())
+		{
+			function(begin, end);
+			return;
+		}
+
+		ParallelForState<typename std::remove_reference<Function>::type> state;
+		state.mFunction = &function;
+		state.mNext.store(begin, std::memory_order_relaxed);
+		state.mEnd = end;
+		state.mGrainSize = grainSize;
+
+		const uint32_t jobCount = static_cast<uint32_t>((std::min)(pieces, static_cast<uint64_t>(GetThreadCount())));
+		std::vector<Job> jobs(jobCount);
+		std::vector<Job*> jobPointers(jobCount);
+		for (uint32_t i = 0; i < jobCount; ++i)
+		{
+			jobs[i].mFunction = [](void* data)
+			{
+				auto& forState = *static_cast<ParallelForState<typename std::remove_reference<Function>::type>*>(data);
+				for (;;)
+				{
+					const uint64_t rangeBegin = forState.mNext.fetch_add(forState.mGrainSize, std::memory_order_relaxed);
+					if (rangeBegin >= forState.mEnd)
+					{
+						return;
+					}
+					const uint64_t rangeEnd = (std::min)(rangeBegin + forState.mGrainSize, forState.mEnd);
+					(*forState.mFunction)(static_cast<uint32_t>(rangeBegin), static_cast<uint32_t>(rangeEnd));
+				}
+			};
+			jobs[i].mData = &state;
+			jobPointers[i] = &jobs[i];
+		}
+
+		JobCounter counter;
+		Run(jobPointers.data(), jobCount, counter);
+		Wait(counter);
+	}
+};
+
+//One T per job thread, each starting on its own cache line so threads filling in their own never share a line. Sized to
+//the thread count when constructed, so the JobSystem has to exist by then. The last slot is a spare shared by every thread
+//that isn't a job thread, so only one of those may use it at a time.
+template<typename T>
+class PerThread
+{
+private:
+	struct alignas(64) Slot
+	{
+		T mValue;
+	};
+	std::vector<Slot> mSlots;
+public:
+	PerThread() : mSlots(JobSystem::Instance()->GetThreadCount() + 1) {}
+
+	//The calling thread's own T, or the spare
+	T& Local()
+	{
+		const uint32_t jobThreads = static_cast<uint32_t>(mSlots.size()) - 1;
+		assert(JobSystem::Instance()->GetThreadCount() == jobThreads && "PerThread: made for a JobSystem with a different thread count");
+		return mSlots[(std::min)(JobSystem::GetThreadIndex(), jobThreads)].mValue;
+	}
+	T& operator[](uint32_t threadIndex) { return mSlots[threadIndex].mValue; }
+	uint32_t GetCount() const { return static_cast<uint32_t>(mSlots.size()); }
+};
\ No newline at end of file
@@ -0,0 +1,29 @@
+#pragma once
+
+//Picks the widest instruction set the compiler is allowed to emit. Define MATH_FORCE_SCALAR to build the plain C++ path.
+//MSVC only defines __AVX2__ for /arch:AVX2 and SSE2 is always available on x64.
+#if !defined(MATH_FORCE_SCALAR) && defined(__AVX2__)
+#define MATH_SIMD_AVX2
+#define MATH_SIMD_SSE2
+#elif !defined(MATH_FORCE_SCALAR) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define MATH_SIMD_SSE2
+#else
+#define MATH_SIMD_SCALAR
+#endif
+
+//Every AVX2 CPU also has F16C. GCC and Clang only allow the intrinsics when -mf16c or -march says so, MSVC always does.
+#if defined(MATH_SIMD_AVX2) && (defined(__F16C__) || defined(_MSC_VER))
+#define MATH_SIMD_F16C
+#endif
+
+#if defined(MATH_SIMD_AVX2)
+#include <immintrin.h>
+#elif defined(MATH_SIMD_SSE2)
+#include <emmintrin.h>
+#endif
+
+#if defined(MATH_SIMD_SSE2)
+#define MATH_SHUFFLE_MASK(x, y, z, w) ((x) | ((y) << 2) | ((z) << 4) | ((w) << 6))
+#define MATH_SWIZZLE(vec, x, y, z, w) _mm_shuffle_ps(vec, vec, MATH_SHUFFLE_MASK(x, y, z, w))
+#define MATH_SPLAT(vec, i) _mm_shuffle_ps(vec, vec, MATH_SHUFFLE_MASK(i, i, i, i))
+#endif
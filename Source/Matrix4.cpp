@@ -1,63 +1,131 @@
 #include "precompiled.hpp"
+#include "MathSIMD.hpp"
 #include "Vector3.hpp"
 #include "Vector4.hpp"
 #include "Matrix4.hpp"
 
-Matrix4::Matrix4() :
-	m11(1.0f),
-	m12(0.0f),
-	m13(0.0f),
-	m14(0.0f),
-	m21(0.0f),
-	m22(1.0f),
-	m23(0.0f),
-	m24(0.0f),
-	m31(0.0f),
-	m32(0.0f),
-	m33(1.0f),
-	m34(0.0f),
-	m41(0.0f),
-	m42(0.0f),
-	m43(0.0f),
-	m44(1.0f)
+#if defined(MATH_SIMD_SSE2)
+namespace
 {
-}
+	inline void LoadColumns(const Matrix4& m, __m128(&cols)[4])
+	{
+		cols[0] = _mm_load_ps(m.matrix[0]);
+		cols[1] = _mm_load_ps(m.matrix[1]);
+		cols[2] = _mm_load_ps(m.matrix[2]);
+		cols[3] = _mm_load_ps(m.matrix[3]);
+	}
 
-Matrix4::Matrix4(float _11, float _21, float _31, float _41, float _12, float _22, float _32, float _42, float _13, float _23, float _33, float _43, float _14, float _24, float _34, float _44) :
-	m11(_11),
-	m12(_12),
-	m13(_13),
-	m14(_14),
-	m21(_21),
-	m22(_22),
-	m23(_23),
-	m24(_24),
-	m31(_31),
-	m32(_32),
-	m33(_33),
-	m34(_34),
-	m41(_41),
-	m42(_42),
-	m43(_43),
-	m44(_44)
-{
+	inline void StoreColumns(Matrix4& m, const __m128(&cols)[4])
+	{
+		_mm_store_ps(m.matrix[0], cols[0]);
+		_mm_store_ps(m.matrix[1], cols[1]);
+		_mm_store_ps(m.matrix[2], cols[2]);
+		_mm_store_ps(m.matrix[3], cols[3]);
+	}
+
+	//The 2x2 helpers work on a packed block | x y |
+	//                                       | z w |
+	inline __m128 Mat2Mul(__m128 a, __m128 b)
+	{
+		return _mm_add_ps(_mm_mul_ps(a, MATH_SWIZZLE(b, 0, 3, 0, 3)), _mm_mul_ps(MATH_SWIZZLE(a, 1, 0, 3, 2), MATH_SWIZZLE(b, 2, 1, 2, 1)));
+	}
+
+	//adj(a) * b
+	inline __m128 Mat2AdjMul(__m128 a, __m128 b)
+	{
+		return _mm_sub_ps(_mm_mul_ps(MATH_SWIZZLE(a, 3, 3, 0, 0), b), _mm_mul_ps(MATH_SWIZZLE(a, 1, 1, 2, 2), MATH_SWIZZLE(b, 2, 3, 0, 1)));
+	}
+
+	//a * adj(b)
+	inline __m128 Mat2MulAdj(__m128 a, __m128 b)
+	{
+		return _mm_sub_ps(_mm_mul_ps(a, MATH_SWIZZLE(b, 3, 0, 3, 0)), _mm_mul_ps(MATH_SWIZZLE(a, 1, 0, 3, 2), MATH_SWIZZLE(b, 2, 1, 2, 1)));
+	}
+
+	//Block wise cofactor expansion. The columns are treated as the rows of the transpose, adj(M^T) = adj(M)^T so the
+	//output lands back in column order. Returns the determinant splatted across all lanes.
+	inline __m128 BlockAdjugate(const __m128(&cols)[4], __m128(&adj)[4])
+	{
+		const __m128 a = _mm_movelh_ps(cols[0], cols[1]);
+		const __m128 b = _mm_movehl_ps(cols[1], cols[0]);
+		const __m128 c = _mm_movelh_ps(cols[2], cols[3]);
+		const __m128 d = _mm_movehl_ps(cols[3], cols[2]);
+
+		//(|A| |B| |C| |D|)
+		const __m128 detSub = _mm_sub_ps(
+			_mm_mul_ps(_mm_shuffle_ps(cols[0], cols[2], MATH_SHUFFLE_MASK(0, 2, 0, 2)), _mm_shuffle_ps(cols[1], cols[3], MATH_SHUFFLE_MASK(1, 3, 1, 3))),
+			_mm_mul_ps(_mm_shuffle_ps(cols[0], cols[2], MATH_SHUFFLE_MASK(1, 3, 1, 3)), _mm_shuffle_ps(cols[1], cols[3], MATH_SHUFFLE_MASK(0, 2, 0, 2))));
+		const __m128 detA = MATH_SPLAT(detSub, 0);
+		const __m128 detB = MATH_SPLAT(detSub, 1);
+		const __m128 detC = MATH_SPLAT(detSub, 2);
+		const __m128 detD = MATH_SPLAT(detSub, 3);
+
+		const __m128 dc = Mat2AdjMul(d, c);
+		const __m128 ab = Mat2AdjMul(a, b);
+
+		const __m128 x = _mm_sub_ps(_mm_mul_ps(detD, a), Mat2Mul(b, dc));
+		const __m128 w = _mm_sub_ps(_mm_mul_ps(detA, d), Mat2Mul(c, ab));
+		const __m128 y = _mm_sub_ps(_mm_mul_ps(detB, c), Mat2MulAdj(d, ab));
+		const __m128 z = _mm_sub_ps(_mm_mul_ps(detC, b), Mat2MulAdj(a, dc));
+
+		//|M| = |A||D| + |B||C| - tr(adj(A)B adj(D)C)
+		__m128 trace = _mm_mul_ps(ab, MATH_SWIZZLE(dc, 0, 2, 1, 3));
+		trace = _mm_add_ps(trace, MATH_SWIZZLE(trace, 2, 3, 0, 1));
+		trace = _mm_add_ps(trace, MATH_SWIZZLE(trace, 1, 0, 3, 2));
+		const __m128 determinant = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(detA, detD), _mm_mul_ps(detB, detC)), trace);
+
+		const __m128 sign = _mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f);
+		const __m128 sx = _mm_mul_ps(x, sign);
+		const __m128 sy = _mm_mul_ps(y, sign);
+		const __m128 sz = _mm_mul_ps(z, sign);
+		const __m128 sw = _mm_mul_ps(w, sign);
+
+		adj[0] = _mm_shuffle_ps(sx, sy, MATH_SHUFFLE_MASK(3, 1, 3, 1));
+		adj[1] = _mm_shuffle_ps(sx, sy, MATH_SHUFFLE_MASK(2, 0, 2, 0));
+		adj[2] = _mm_shuffle_ps(sz, sw, MATH_SHUFFLE_MASK(3, 1, 3, 1));
+		adj[3] = _mm_shuffle_ps(sz, sw, MATH_SHUFFLE_MASK(2, 0, 2, 0));
+		return determinant;
+	}
 }
+#endif
 
 //m11 m21 m31 m41
 //m12 m22 m32 m42
 //m13 m23 m33 m43
 //m14 m24 m34 m44
 
-float Matrix4::Determinant()
+Matrix4 Matrix4::Perspective(float fovDegrees, float aspectRatio, float nearPlane, float farPlane)
+{
+	return PerspectiveFromTan(std::tan((fovDegrees * piOver180) * 0.5f), aspectRatio, nearPlane, farPlane);
+}
+
+float Matrix4::Determinant() const
 {
+#if defined(MATH_SIMD_SSE2)
+	__m128 cols[4];
+	__m128 adj[4];
+	LoadColumns(*this, cols);
+	return _mm_cvtss_f32(BlockAdjugate(cols, adj));
+#else
 	return  (((m11 * (m22 * (m33 * m44 - (m34 * m43)) - m32 * (m23 * m44 - (m24 * m43)) + m42 * (m23 * m34 - (m24 * m33))))
 		- (m21 * (m12 * (m33 * m44 - (m34 * m43)) - m32 * (m13 * m44 - (m14 * m43)) + m42 * (m13 * m34 - (m14 * m33)))))
 		+ (m31 * (m12 * (m23 * m44 - (m24 * m43)) - m22 * (m13 * m44 - (m14 * m43)) + m42 * (m13 * m24 - (m14 * m23)))))
 		- (m41 * (m12 * (m23 * m34 - (m24 * m33)) - m22 * (m13 * m34 - (m14 * m33)) + m32 * (m13 * m24 - (m14 * m23))));
+#endif
 }
 
-Matrix4 Matrix4::Adjugate()
+Matrix4 Matrix4::Adjugate() const
 {
+#if defined(MATH_SIMD_SSE2)
+	__m128 cols[4];
+	__m128 adj[4];
+	LoadColumns(*this, cols);
+	BlockAdjugate(cols, adj);
+
+	Matrix4 result;
+	StoreColumns(result, adj);
+	return result;
+#else
 	return Matrix4
 	(
 		(m22 * ((m33 * m44) - (m34 * m43)) - m32 * ((m23 * m44) - (m24 * m43)) + m42 * ((m23 * m34) - (m24 * m33))),
@@ -80,17 +148,45 @@ Matrix4 Matrix4::Adjugate()
 		-(m11 * ((m22 * m34) - (m24 * m32)) - m21 * ((m12 * m34) - (m14 * m32)) + m31 * ((m12 * m24) - (m14 * m22))),
 		(m11 * ((m22 * m33) - (m23 * m32)) - m21 * ((m12 * m33) - (m13 * m32)) + m31 * ((m12 * m23) - (m13 * m22)))
 	);
+#endif
 }
 
-Matrix4 Matrix4::Inverse()
+Matrix4 Matrix4::Inverse() const
 {
+#if defined(MATH_SIMD_SSE2)
+	__m128 cols[4];
+	__m128 adj[4];
+	LoadColumns(*this, cols);
+	const __m128 determinant = BlockAdjugate(cols, adj);
+	assert(_mm_cvtss_f32(determinant) != 0);
+
+	const __m128 invDeterminant = _mm_div_ps(_mm_set1_ps(1.0f), determinant);
+	adj[0] = _mm_mul_ps(adj[0], invDeterminant);
+	adj[1] = _mm_mul_ps(adj[1], invDeterminant);
+	adj[2] = _mm_mul_ps(adj[2], invDeterminant);
+	adj[3] = _mm_mul_ps(adj[3], invDeterminant);
+
+	Matrix4 result;
+	StoreColumns(result, adj);
+	return result;
+#else
 	const float determinant = Determinant();
 	assert(determinant != 0);
 	return Adjugate() * (1.0f / determinant);
+#endif
 }
 
-Matrix4 Matrix4::Transpose()
+Matrix4 Matrix4::Transpose() const
 {
+#if defined(MATH_SIMD_SSE2)
+	__m128 cols[4];
+	LoadColumns(*this, cols);
+	_MM_TRANSPOSE4_PS(cols[0], cols[1], cols[2], cols[3]);
+
+	Matrix4 result;
+	StoreColumns(result, cols);
+	return result;
+#else
 	return Matrix4
 	(
 		m11, m12, m13, m14,
@@ -98,6 +194,7 @@ Matrix4 Matrix4::Transpose()
 		m31, m32, m33, m34,
 		m41, m42, m43, m44
 	);
+#endif
 }
 
 float* Matrix4::operator[](uint32_t i)
@@ -114,6 +211,21 @@ const float* Matrix4::operator[](uint32_t i) const
 
 Vector4 Matrix4::operator*(const Vector4 & vec) const
 {
+#if defined(MATH_SIMD_SSE2)
+	//Each output lane is the dot of one column with vec, so multiply per column and transpose to sum across
+	const __m128 v = _mm_load_ps(vec.vector);
+	__m128 products[4];
+	LoadColumns(*this, products);
+	products[0] = _mm_mul_ps(products[0], v);
+	products[1] = _mm_mul_ps(products[1], v);
+	products[2] = _mm_mul_ps(products[2], v);
+	products[3] = _mm_mul_ps(products[3], v);
+	_MM_TRANSPOSE4_PS(products[0], products[1], products[2], products[3]);
+
+	Vector4 result;
+	_mm_store_ps(result.vector, _mm_add_ps(_mm_add_ps(products[0], products[1]), _mm_add_ps(products[2], products[3])));
+	return result;
+#else
 	return Vector4
 	(
 		vec.x * matrix[0][0] + vec.y * matrix[0][1] + vec.z * matrix[0][2] + vec.w * matrix[0][3],
@@ -121,6 +233,7 @@ Vector4 Matrix4::operator*(const Vector4 & vec) const
 		vec.x * matrix[2][0] + vec.y * matrix[2][1] + vec.z * matrix[2][2] + vec.w * matrix[2][3],
 		vec.x * matrix[3][0] + vec.y * matrix[3][1] + vec.z * matrix[3][2] + vec.w * matrix[3][3]
 	);
+#endif
 }
 
 Vector3 Matrix4::operator*(const Vector3 & vec) const
@@ -130,8 +243,21 @@ Vector3 Matrix4::operator*(const Vector3 & vec) const
 	return tmp;
 }
 
-Matrix4 Matrix4::operator*(float fl)
+Matrix4 Matrix4::operator*(float fl) const
 {
+#if defined(MATH_SIMD_SSE2)
+	const __m128 scale = _mm_set1_ps(fl);
+	__m128 cols[4];
+	LoadColumns(*this, cols);
+	cols[0] = _mm_mul_ps(cols[0], scale);
+	cols[1] = _mm_mul_ps(cols[1], scale);
+	cols[2] = _mm_mul_ps(cols[2], scale);
+	cols[3] = _mm_mul_ps(cols[3], scale);
+
+	Matrix4 result;
+	StoreColumns(result, cols);
+	return result;
+#else
 	return Matrix4
 	(
 		m11 * fl, m21 * fl, m31 * fl, m41 * fl,
@@ -139,11 +265,41 @@ Matrix4 Matrix4::operator*(float fl)
 		m13 * fl, m23 * fl, m33 * fl, m43 * fl,
 		m14 * fl, m24 * fl, m34 * fl, m44 * fl
 	);
+#endif
 }
 
-Matrix4 Matrix4::operator*(const Matrix4& b)
+Matrix4 Matrix4::operator*(const Matrix4& b) const
 {
-	return Matrix4
+	Matrix4 result;
+#if defined(MATH_SIMD_AVX2)
+	//Two result columns per iteration, column j of the result is this * column j of b
+	const __m256 a0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(matrix[0]));
+	const __m256 a1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(matrix[1]));
+	const __m256 a2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(matrix[2]));
+	const __m256 a3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(matrix[3]));
+	for (uint32_t i = 0; i < 4; i += 2)
+	{
+		const __m256 bCols = _mm256_loadu_ps(b.matrix[i]);
+		__m256 col = _mm256_mul_ps(a0, _mm256_permute_ps(bCols, 0x00));
+		col = _mm256_fmadd_ps(a1, _mm256_permute_ps(bCols, 0x55), col);
+		col = _mm256_fmadd_ps(a2, _mm256_permute_ps(bCols, 0xAA), col);
+		col = _mm256_fmadd_ps(a3, _mm256_permute_ps(bCols, 0xFF), col);
+		_mm256_storeu_ps(result.matrix[i], col);
+	}
+#elif defined(MATH_SIMD_SSE2)
+	__m128 cols[4];
+	LoadColumns(*this, cols);
+	for (uint32_t i = 0; i < 4; ++i)
+	{
+		const __m128 bCol = _mm_load_ps(b.matrix[i]);
+		__m128 col = _mm_mul_ps(cols[0], MATH_SPLAT(bCol, 0));
+		col = _mm_add_ps(col, _mm_mul_ps(cols[1], MATH_SPLAT(bCol, 1)));
+		col = _mm_add_ps(col, _mm_mul_ps(cols[2], MATH_SPLAT(bCol, 2)));
+		col = _mm_add_ps(col, _mm_mul_ps(cols[3], MATH_SPLAT(bCol, 3)));
+		_mm_store_ps(result.matrix[i], col);
+	}
+#else
+	result = Matrix4
 	(
 		(m11 * b.m11) + (m21 * b.m12) + (m31 * b.m13) + (m41 * b.m14), //m11
 		(m11 * b.m21) + (m21 * b.m22) + (m31 * b.m23) + (m41 * b.m24), //m21
@@ -165,4 +321,6 @@ Matrix4 Matrix4::operator*(const Matrix4& b)
 		(m14 * b.m31) + (m24 * b.m32) + (m34 * b.m33) + (m44 * b.m34), //m34
 		(m14 * b.m41) + (m24 * b.m42) + (m34 * b.m43) + (m44 * b.m44)  //m44
 	);
+#endif
+	return result;
 }
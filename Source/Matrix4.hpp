@@ -1,9 +1,10 @@
 #pragma once
+#include "Vector3.hpp"
+#include "MathConstants.hpp"
 
-//Old matrix class
-class Vector3;
+//Column major, each column is 16 byte aligned so the SIMD paths in Matrix4.cpp can load it directly
 class Vector4;
-class Matrix4
+class alignas(16) Matrix4
 {
 public:
 	union //Use variant
@@ -29,21 +30,78 @@ public:
 		};
 		float matrix[4][4];
 	};
-	Matrix4();
-	Matrix4(
+	constexpr Matrix4() :
+		m11(1.0f), m12(0.0f), m13(0.0f), m14(0.0f),
+		m21(0.0f), m22(1.0f), m23(0.0f), m24(0.0f),
+		m31(0.0f), m32(0.0f), m33(1.0f), m34(0.0f),
+		m41(0.0f), m42(0.0f), m43(0.0f), m44(1.0f)
+	{
+	}
+	constexpr Matrix4(
 		float _11, float _21, float _31, float _41,
 		float _12, float _22, float _32, float _42,
 		float _13, float _23, float _33, float _43,
-		float _14, float _24, float _34, float _44);
-	float Determinant();
-	Matrix4 Adjugate();
-	Matrix4 Inverse();
-	Matrix4 Transpose();
+		float _14, float _24, float _34, float _44) :
+		m11(_11), m12(_12), m13(_13), m14(_14),
+		m21(_21), m22(_22), m23(_23), m24(_24),
+		m31(_31), m32(_32), m33(_33), m34(_34),
+		m41(_41), m42(_42), m43(_43), m44(_44)
+	{
+	}
+
+	static constexpr Matrix4 Translation(const Vector3& t)
+	{
+		return Matrix4
+		(
+			1.0f, 0.0f, 0.0f, t.x,
+			0.0f, 1.0f, 0.0f, t.y,
+			0.0f, 0.0f, 1.0f, t.z,
+			0.0f, 0.0f, 0.0f, 1.0f
+		);
+	}
+
+	static constexpr Matrix4 Scale(const Vector3& s)
+	{
+		return Matrix4
+		(
+			s.x, 0.0f, 0.0f, 0.0f,
+			0.0f, s.y, 0.0f, 0.0f,
+			0.0f, 0.0f, s.z, 0.0f,
+			0.0f, 0.0f, 0.0f, 1.0f
+		);
+	}
+
+	//Right handed with Vulkan's 0 to 1 depth range. Uses std::tan, so a projection rebuilt every frame stays cheap.
+	static Matrix4 Perspective(float fovDegrees, float aspectRatio, float nearPlane, float farPlane);
+	//Same projection from the constexpr tan, for fixed projections that should fold at compile time. Much slower at run time.
+	static constexpr Matrix4 ConstexprPerspective(float fovDegrees, float aspectRatio, float nearPlane, float farPlane)
+	{
+		return PerspectiveFromTan(ConstexprMath::Tan((fovDegrees * piOver180) * 0.5f), aspectRatio, nearPlane, farPlane);
+	}
+
+	float Determinant() const;
+	Matrix4 Adjugate() const;
+	Matrix4 Inverse() const;
+	Matrix4 Transpose() const;
 
 	float* operator[](uint32_t i);
 	const float* operator[](uint32_t i) const;
 	Vector4 operator*(const Vector4& vec) const;
 	Vector3 operator*(const Vector3& vec) const;
-	Matrix4 operator*(float fl);
-	Matrix4 operator*(const Matrix4& b);
+	Matrix4 operator*(float fl) const;
+	Matrix4 operator*(const Matrix4& b) const;
+
+private:
+	static constexpr Matrix4 PerspectiveFromTan(float halfFovTan, float aspectRatio, float nearPlane, float farPlane)
+	{
+		const float h = 1.0f / halfFovTan;
+		const float w = 1.0f / (halfFovTan * aspectRatio);
+		return Matrix4
+		(
+			w, 0.0f, 0.0f, 0.0f,
+			0.0f, h, 0.0f, 0.0f,
+			0.0f, 0.0f, farPlane / (nearPlane - farPlane), -(farPlane * nearPlane) / (farPlane - nearPlane),
+			0.0f, 0.0f, -1.0f, 0.0f
+		);
+	}
 };
\ No newline at end of file
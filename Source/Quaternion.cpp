@@ -1,12 +1,81 @@
 #include "precompiled.hpp"
+#include "MathSIMD.hpp"
 #include "Matrix4.hpp"
 #include "Vector3.hpp"
 #include "MathConstants.hpp"
+#include "TransformBatch.hpp"
+#include "FastMath.hpp"
 #include "Quaternion.hpp"
 
-Quaternion::Quaternion(float inX, float inY, float inZ, float inW) : x(inX), y(inY), z(inZ), w(inW)
+#if defined(MATH_SIMD_SSE2)
+namespace
 {
+	//Hamilton product on four quaternions held as x, y, z, w lanes
+	inline void MultiplySoA(const __m128(&a)[4], const __m128(&b)[4], __m128(&out)[4])
+	{
+		out[0] = _mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(a[3], b[0]), _mm_mul_ps(a[0], b[3])), _mm_mul_ps(a[1], b[2])), _mm_mul_ps(a[2], b[1]));
+		out[1] = _mm_add_ps(_mm_add_ps(_mm_sub_ps(_mm_mul_ps(a[3], b[1]), _mm_mul_ps(a[0], b[2])), _mm_mul_ps(a[1], b[3])), _mm_mul_ps(a[2], b[0]));
+		out[2] = _mm_add_ps(_mm_sub_ps(_mm_add_ps(_mm_mul_ps(a[3], b[2]), _mm_mul_ps(a[0], b[1])), _mm_mul_ps(a[1], b[0])), _mm_mul_ps(a[2], b[3]));
+		out[3] = _mm_sub_ps(_mm_sub_ps(_mm_sub_ps(_mm_mul_ps(a[3], b[3]), _mm_mul_ps(a[0], b[0])), _mm_mul_ps(a[1], b[1])), _mm_mul_ps(a[2], b[2]));
+	}
 
+	inline void LoadSoA(const Quaternion* q, __m128(&lanes)[4])
+	{
+		lanes[0] = _mm_load_ps(q[0].quaternion);
+		lanes[1] = _mm_load_ps(q[1].quaternion);
+		lanes[2] = _mm_load_ps(q[2].quaternion);
+		lanes[3] = _mm_load_ps(q[3].quaternion);
+		_MM_TRANSPOSE4_PS(lanes[0], lanes[1], lanes[2], lanes[3]);
+	}
+
+	inline void StoreSoA(Quaternion* q, __m128(&lanes)[4])
+	{
+		_MM_TRANSPOSE4_PS(lanes[0], lanes[1], lanes[2], lanes[3]);
+		_mm_store_ps(q[0].quaternion, lanes[0]);
+		_mm_store_ps(q[1].quaternion, lanes[1]);
+		_mm_store_ps(q[2].quaternion, lanes[2]);
+		_mm_store_ps(q[3].quaternion, lanes[3]);
+	}
+}
+#endif
+
+Quaternion Quaternion::FromAngleAxis(float degrees, const Vector3& axis)
+{
+	Quaternion result;
+	result.RotateAngleAxis(degrees, axis);
+	return result;
+}
+
+Quaternion Quaternion::FromAngleAxisFast(float degrees, const Vector3& axis)
+{
+	float s;
+	float c;
+	FastMath::SinCos((degrees * piOver180) * 0.5f, s, c);
+	const Vector3 a = FastMath::Normalize(axis);
+	return Quaternion(a.x * s, a.y * s, a.z * s, c);
+}
+
+Quaternion Quaternion::FromAxes(const Vector3& xAxis, const Vector3& yAxis, const Vector3& zAxis)
+{
+	//Solve off the largest of w, x, y, z so the divide never goes near zero
+	const float trace = xAxis.x + yAxis.y + zAxis.z;
+	if (trace > 0.0f)
+	{
+		const float s = 0.5f / sqrt(trace + 1.0f);
+		return Quaternion((yAxis.z - zAxis.y) * s, (zAxis.x - xAxis.z) * s, (xAxis.y - yAxis.x) * s, 0.25f / s);
+	}
+	if (xAxis.x > yAxis.y && xAxis.x > zAxis.z)
+	{
+		const float s = 0.5f / sqrt(1.0f + xAxis.x - yAxis.y - zAxis.z);
+		return Quaternion(0.25f / s, (yAxis.x + xAxis.y) * s, (zAxis.x + xAxis.z) * s, (yAxis.z - zAxis.y) * s);
+	}
+	if (yAxis.y > zAxis.z)
+	{
+		const float s = 0.5f / sqrt(1.0f + yAxis.y - xAxis.x - zAxis.z);
+		return Quaternion((yAxis.x + xAxis.y) * s, 0.25f / s, (zAxis.y + yAxis.z) * s, (zAxis.x - xAxis.z) * s);
+	}
+	const float s = 0.5f / sqrt(1.0f + zAxis.z - xAxis.x - yAxis.y);
+	return Quaternion((zAxis.x + xAxis.z) * s, (zAxis.y + yAxis.z) * s, 0.25f / s, (xAxis.y - yAxis.x) * s);
 }
 
 void Quaternion::RotateAngleAxis(float degrees, const Vector3 & axis)
@@ -34,7 +103,191 @@ Matrix4 Quaternion::GetMatrix() const
 	);
 }
 
+Matrix4 Quaternion::GetTRSMatrix(const Vector3& translation, const Vector3& scale) const
+{
+	const float xx = 2.0f * x * x;
+	const float yy = 2.0f * y * y;
+	const float zz = 2.0f * z * z;
+	const float xy = 2.0f * x * y;
+	const float xz = 2.0f * x * z;
+	const float yz = 2.0f * y * z;
+	const float xw = 2.0f * x * w;
+	const float yw = 2.0f * y * w;
+	const float zw = 2.0f * z * w;
+
+	return Matrix4
+	(
+		(1.0f - yy - zz) * scale.x, (xy - zw) * scale.y, (xz + yw) * scale.z, translation.x,
+		(xy + zw) * scale.x, (1.0f - xx - zz) * scale.y, (yz - xw) * scale.z, translation.y,
+		(xz - yw) * scale.x, (yz + xw) * scale.y, (1.0f - xx - yy) * scale.z, translation.z,
+		0.0f, 0.0f, 0.0f, 1.0f
+	);
+}
+
+float Quaternion::Magnitude() const
+{
+	return sqrt(Dot(*this));
+}
+
+Quaternion Quaternion::GetNormal() const
+{
+	const float magnitude = Magnitude();
+	assert(magnitude != 0.0f);
+	const float dec = 1.0f / magnitude;
+	return Quaternion(x * dec, y * dec, z * dec, w * dec);
+}
+
+Quaternion Quaternion::Inverse() const
+{
+	const float lengthSquared = Dot(*this);
+	assert(lengthSquared != 0.0f);
+	const float dec = 1.0f / lengthSquared;
+	return Quaternion(-x * dec, -y * dec, -z * dec, w * dec);
+}
+
+Vector3 Quaternion::Rotate(const Vector3& vec) const
+{
+	//v + 2w(u x v) + 2u x (u x v) without building the matrix
+	const Vector3 u = Vector3(x, y, z);
+	const Vector3 t = u.Cross(vec) * 2.0f;
+	return vec + (t * w) + u.Cross(t);
+}
+
+Quaternion Quaternion::Nlerp(const Quaternion& a, const Quaternion& b, float t)
+{
+	const float bias = a.Dot(b) < 0.0f ? -1.0f : 1.0f;
+	return Quaternion
+	(
+		a.x + ((b.x * bias) - a.x) * t,
+		a.y + ((b.y * bias) - a.y) * t,
+		a.z + ((b.z * bias) - a.z) * t,
+		a.w + ((b.w * bias) - a.w) * t
+	).GetNormal();
+}
+
+Quaternion Quaternion::Slerp(const Quaternion& a, const Quaternion& b, float t)
+{
+	float cosTheta = a.Dot(b);
+	const float bias = cosTheta < 0.0f ? -1.0f : 1.0f;
+	cosTheta *= bias;
+
+	//Nearly parallel, sin(theta) heads to zero so fall back to nlerp
+	if (cosTheta > 0.9995f)
+	{
+		return Nlerp(a, b, t);
+	}
+
+	const float theta = acos(cosTheta);
+	const float invSinTheta = 1.0f / sin(theta);
+	const float weightA = sin((1.0f - t) * theta) * invSinTheta;
+	const float weightB = sin(t * theta) * invSinTheta * bias;
+	return Quaternion
+	(
+		(a.x * weightA) + (b.x * weightB),
+		(a.y * weightA) + (b.y * weightB),
+		(a.z * weightA) + (b.z * weightB),
+		(a.w * weightA) + (b.w * weightB)
+	);
+}
+
+void Quaternion::MultiplyBatch(const Quaternion* a, const Quaternion* b, Quaternion* out, size_t count)
+{
+	size_t i = 0;
+#if defined(MATH_SIMD_SSE2)
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128 lanesA[4];
+		__m128 lanesB[4];
+		__m128 result[4];
+		LoadSoA(a + i, lanesA);
+		LoadSoA(b + i, lanesB);
+		MultiplySoA(lanesA, lanesB, result);
+		StoreSoA(out + i, result);
+	}
+#endif
+	for (; i < count; ++i)
+	{
+		out[i] = a[i] * b[i];
+	}
+}
+
+void Quaternion::NlerpBatch(const Quaternion* a, const Quaternion* b, float t, Quaternion* out, size_t count)
+{
+	size_t i = 0;
+#if defined(MATH_SIMD_SSE2)
+	const __m128 weight = _mm_set1_ps(t);
+	const __m128 signBit = _mm_set1_ps(-0.0f);
+	const __m128 one = _mm_set1_ps(1.0f);
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128 lanesA[4];
+		__m128 lanesB[4];
+		LoadSoA(a + i, lanesA);
+		LoadSoA(b + i, lanesB);
+
+		//Flip b wherever the dot is negative so every lane takes the short way round
+		const __m128 dot = _mm_add_ps(_mm_add_ps(_mm_mul_ps(lanesA[0], lanesB[0]), _mm_mul_ps(lanesA[1], lanesB[1])),
+			_mm_add_ps(_mm_mul_ps(lanesA[2], lanesB[2]), _mm_mul_ps(lanesA[3], lanesB[3])));
+		const __m128 flip = _mm_and_ps(dot, signBit);
+
+		__m128 lengthSquared = _mm_setzero_ps();
+		for (uint32_t c = 0; c < 4; ++c)
+		{
+			const __m128 target = _mm_xor_ps(lanesB[c], flip);
+			lanesA[c] = _mm_add_ps(lanesA[c], _mm_mul_ps(_mm_sub_ps(target, lanesA[c]), weight));
+			lengthSquared = _mm_add_ps(lengthSquared, _mm_mul_ps(lanesA[c], lanesA[c]));
+		}
+
+		const __m128 invLength = _mm_div_ps(one, _mm_sqrt_ps(lengthSquared));
+		for (uint32_t c = 0; c < 4; ++c)
+		{
+			lanesA[c] = _mm_mul_ps(lanesA[c], invLength);
+		}
+		StoreSoA(out + i, lanesA);
+	}
+#endif
+	for (; i < count; ++i)
+	{
+		out[i] = Nlerp(a[i], b[i], t);
+	}
+}
+
+void Quaternion::RotateBatch(const Quaternion& rotation, ConstVector3Stream in, Vector3Stream out, size_t count)
+{
+	size_t i = 0;
+#if defined(MATH_SIMD_SSE2)
+	const __m128 ux = _mm_set1_ps(rotation.x);
+	const __m128 uy = _mm_set1_ps(rotation.y);
+	const __m128 uz = _mm_set1_ps(rotation.z);
+	const __m128 uw = _mm_set1_ps(rotation.w);
+	const __m128 two = _mm_set1_ps(2.0f);
+	for (; i + 4 <= count; i += 4)
+	{
+		const __m128 vx = _mm_loadu_ps(in.x + i);
+		const __m128 vy = _mm_loadu_ps(in.y + i);
+		const __m128 vz = _mm_loadu_ps(in.z + i);
+
+		//t = 2(u x v)
+		const __m128 tx = _mm_mul_ps(two, _mm_sub_ps(_mm_mul_ps(uy, vz), _mm_mul_ps(uz, vy)));
+		const __m128 ty = _mm_mul_ps(two, _mm_sub_ps(_mm_mul_ps(uz, vx), _mm_mul_ps(ux, vz)));
+		const __m128 tz = _mm_mul_ps(two, _mm_sub_ps(_mm_mul_ps(ux, vy), _mm_mul_ps(uy, vx)));
+
+		//v + wt + u x t
+		_mm_storeu_ps(out.x + i, _mm_add_ps(_mm_add_ps(vx, _mm_mul_ps(uw, tx)), _mm_sub_ps(_mm_mul_ps(uy, tz), _mm_mul_ps(uz, ty))));
+		_mm_storeu_ps(out.y + i, _mm_add_ps(_mm_add_ps(vy, _mm_mul_ps(uw, ty)), _mm_sub_ps(_mm_mul_ps(uz, tx), _mm_mul_ps(ux, tz))));
+		_mm_storeu_ps(out.z + i, _mm_add_ps(_mm_add_ps(vz, _mm_mul_ps(uw, tz)), _mm_sub_ps(_mm_mul_ps(ux, ty), _mm_mul_ps(uy, tx))));
+	}
+#endif
+	for (; i < count; ++i)
+	{
+		const Vector3 rotated = rotation.Rotate(Vector3(in.x[i], in.y[i], in.z[i]));
+		out.x[i] = rotated.x;
+		out.y[i] = rotated.y;
+		out.z[i] = rotated.z;
+	}
+}
+
 float & Quaternion::operator[](uint32_t i)
 {
 	return quaternion[i];
-}
\ No newline at end of file
+}
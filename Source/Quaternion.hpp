@@ -2,7 +2,9 @@
 
 class Vector3;
 class Matrix4;
-class Quaternion
+struct Vector3Stream;
+struct ConstVector3Stream;
+class alignas(16) Quaternion
 {
 public:
 	union
@@ -17,8 +19,46 @@ public:
 		float quaternion[4];
 	};
 	Quaternion() = default;
-	Quaternion(float inX, float inY, float inZ, float inW);
+	constexpr Quaternion(float inX, float inY, float inZ, float inW) : x(inX), y(inY), z(inZ), w(inW) {}
+	static constexpr Quaternion Identity() { return Quaternion(0.0f, 0.0f, 0.0f, 1.0f); }
+	static Quaternion FromAngleAxis(float degrees, const Vector3& axis);
+	//FastMath sincos and normalize instead of libm, see FastMath.hpp for the error bounds
+	static Quaternion FromAngleAxisFast(float degrees, const Vector3& axis);
+	//Rotation whose matrix has these columns, they must be orthonormal and right handed
+	static Quaternion FromAxes(const Vector3& xAxis, const Vector3& yAxis, const Vector3& zAxis);
+
 	void RotateAngleAxis(float degrees, const Vector3& axis);
 	Matrix4 GetMatrix() const;
+	//Translation * rotation * scale built straight from the quaternion, no intermediate matrices
+	Matrix4 GetTRSMatrix(const Vector3& translation, const Vector3& scale) const;
+
+	constexpr float Dot(const Quaternion& b) const { return (x * b.x) + (y * b.y) + (z * b.z) + (w * b.w); }
+	float Magnitude() const;
+	Quaternion GetNormal() const;
+	constexpr Quaternion Conjugate() const { return Quaternion(-x, -y, -z, w); }
+	Quaternion Inverse() const;
+	//Same result as GetMatrix() applied to a column vector, expects a unit quaternion
+	Vector3 Rotate(const Vector3& vec) const;
+
+	//Both take the shortest arc and return a unit quaternion. Nlerp is cheaper but does not keep a constant angular velocity.
+	static Quaternion Nlerp(const Quaternion& a, const Quaternion& b, float t);
+	static Quaternion Slerp(const Quaternion& a, const Quaternion& b, float t);
+
+	//Batched versions, four quaternions or vectors per SIMD iteration. out may alias the inputs.
+	static void MultiplyBatch(const Quaternion* a, const Quaternion* b, Quaternion* out, size_t count);
+	static void NlerpBatch(const Quaternion* a, const Quaternion* b, float t, Quaternion* out, size_t count);
+	static void RotateBatch(const Quaternion& rotation, ConstVector3Stream in, Vector3Stream out, size_t count);
+
 	float& operator[](uint32_t i);
+	//a * b applies b first then a
+	constexpr Quaternion operator*(const Quaternion& b) const
+	{
+		return Quaternion
+		(
+			(w * b.x) + (x * b.w) + (y * b.z) - (z * b.y),
+			(w * b.y) - (x * b.z) + (y * b.w) + (z * b.x),
+			(w * b.z) + (x * b.y) - (y * b.x) + (z * b.w),
+			(w * b.w) - (x * b.x) - (y * b.y) - (z * b.z)
+		);
+	}
 };
\ No newline at end of file
@@ -1,46 +1,129 @@
 #include "precompiled.hpp"
 #include "Vector3.hpp"
-#include "Matrix4.hpp"
+#include "AffineTransform.hpp"
+#include "TransformStore.hpp"
+#include "EntityWorld.hpp"
+#include "JobSystem.hpp"
 #include "MathConstants.hpp"
 #include "RenderVertex.hpp"
 #include "Graphics.hpp"
 #include "RenderObject.hpp"
 
-RenderObject::RenderObject(std::vector<RenderVertex> vertexBuffer, std::vector<uint32_t> indexBuffer) :
+#include <algorithm>
+
+RenderMesh::RenderMesh(std::vector<RenderVertex> vertexBuffer, std::vector<uint32_t> indexBuffer) :
 	mRawVertexBuffer(std::move(vertexBuffer)),
-	mRawIndexBuffer(std::move(indexBuffer)),
-	mVertexBuffer(static_cast<uint32_t>(mRawVertexBuffer.size() * sizeof(RenderVertex)), reinterpret_cast<uint8_t*>(mRawVertexBuffer.data()), hal::BufferType::VertexBuffer),
-	mIndexBuffer(static_cast<uint32_t>(mRawIndexBuffer.size() * sizeof(uint32_t)), reinterpret_cast<uint8_t*>(mRawIndexBuffer.data()), hal::BufferType::IndexBuffer),
-	mDrawInfo(Graphics::Instance()->GetPipeline()),
-	mDrawBuffer(Graphics::Instance()->GetCommandPool(), { &mDrawInfo })
+	mRawIndexBuffer(std::move(indexBuffer))
+{
+}
+
+RenderMesh::Resources::Resources(RenderMesh& mesh) :
+	mVertexBuffer(static_cast<uint32_t>(mesh.mRawVertexBuffer.size() * sizeof(RenderVertex)), reinterpret_cast<uint8_t*>(mesh.mRawVertexBuffer.data()), hal::BufferType::VertexBuffer),
+	mIndexBuffer(static_cast<uint32_t>(mesh.mRawIndexBuffer.size() * sizeof(uint32_t)), reinterpret_cast<uint8_t*>(mesh.mRawIndexBuffer.data()), hal::BufferType::IndexBuffer),
+	mDrawInfo(Graphics::Instance()->GetPipeline())
 {
 	mDrawInfo.AddBuffer(&mVertexBuffer); //Make a way to pass to constructor
 	mDrawInfo.AddBuffer(&mIndexBuffer);
+}
+
+RenderMeshComponent::~RenderMeshComponent()
+{
+	if (mMesh != nullptr)
+	{
+		Graphics::Instance()->DestroyMesh(mMesh);
+	}
+}
+
+RenderObject::RenderObject(std::vector<RenderVertex> vertexBuffer, std::vector<uint32_t> indexBuffer)
+{
+	//Sphere around the centre of the vertex AABB, not the tightest fit but cheap and good enough for culling
+	RenderBounds bounds;
+	if (!vertexBuffer.empty())
+	{
+		Vector3 min = vertexBuffer[0].mPosition;
+		Vector3 max = min;
+		for (const auto& vertex : vertexBuffer)
+		{
+			min = Vector3((std::min)(min.x, vertex.mPosition.x), (std::min)(min.y, vertex.mPosition.y), (std::min)(min.z, vertex.mPosition.z));
+			max = Vector3((std::max)(max.x, vertex.mPosition.x), (std::max)(max.y, vertex.mPosition.y), (std::max)(max.z, vertex.mPosition.z));
+		}
+		bounds.mLocalBounds.mCenter = (min + max) * 0.5f;
+		for (const auto& vertex : vertexBuffer)
+		{
+			bounds.mLocalBounds.mRadius = (std::max)(bounds.mLocalBounds.mRadius, (vertex.mPosition - bounds.mLocalBounds.mCenter).MagnitudeSquared());
+		}
+		bounds.mLocalBounds.mRadius = sqrt(bounds.mLocalBounds.mRadius);
+	}
 
-	Graphics::Instance()->AddRenderObject(this);
-	Graphics::Instance()->RebuildRenderInfo();
+	RenderMeshComponent mesh;
+	mesh.mMesh = new RenderMesh(std::move(vertexBuffer), std::move(indexBuffer));
+	Graphics::Instance()->CreateMesh(mesh.mMesh);
+	mEntity = EntityWorld::Instance()->CreateEntity(RenderTransform{ TransformStore::Instance()->Create() }, bounds, RenderSpin(), std::move(mesh));
 }
 
-Matrix4 RenderObject::GetModelMatrix() const
+RenderObject::~RenderObject()
 {
-	return (mXRotation.GetMatrix() * mYRotation.GetMatrix()) *
-		Matrix4
-		(
-			mScale.x, 0.0f, 0.0f, mPosition.x,
-			0.0f, mScale.y, 0.0f, mPosition.z, //I believe this is because Z is "up"
-			0.0f, 0.0f, mScale.z, mPosition.y,
-			0.0f, 0.0f, 0.0f, 1.0f
-		);
+	if (EntityWorld::Instance()->Has<RenderStatic>(mEntity))
+	{
+		Graphics::Instance()->MarkStaticDirty();
+	}
+	TransformStore::Instance()->Destroy(GetTransform());
+	EntityWorld::Instance()->DestroyEntity(mEntity);
 }
 
-void RenderObject::Update()
+TransformHandle RenderObject::GetTransform() const
 {
-	currentAngleX += 1.0f;
-	currentAngleX = fmod(currentAngleX, 360.0f);
-	currentAngleY += 1.0f;
-	currentAngleY = fmod(currentAngleY, 360.0f);
-	mXRotation.RotateAngleAxis(currentAngleX, up);
-	mYRotation.RotateAngleAxis(currentAngleY, right); 
-	mDrawInfo.UpdateBuffer(hal::BufferType::VertexBuffer, 0, reinterpret_cast<uint8_t*>(mRawVertexBuffer.data()));
-	mDrawInfo.UpdateBuffer(hal::BufferType::IndexBuffer, 0, reinterpret_cast<uint8_t*>(mRawIndexBuffer.data()));
+	return EntityWorld::Instance()->Get<RenderTransform>(mEntity)->mTransform;
+}
+
+void RenderObject::SetPosition(const Vector3& position)
+{
+	//I believe the y/z swap is because Z is "up"
+	TransformStore::Instance()->SetLocalPosition(GetTransform(), Vector3(position.x, position.z, position.y));
+	if (EntityWorld::Instance()->Has<RenderStatic>(mEntity))
+	{
+		Graphics::Instance()->MarkStaticDirty();
+	}
+}
+
+void RenderObject::MakeStatic()
+{
+	if (EntityWorld::Instance()->Has<RenderStatic>(mEntity))
+	{
+		return;
+	}
+	if (EntityWorld::Instance()->Has<RenderSpin>(mEntity))
+	{
+		EntityWorld::Instance()->RemoveComponent<RenderSpin>(mEntity);
+	}
+	EntityWorld::Instance()->AddComponent(mEntity, RenderStatic());
+	Graphics::Instance()->MarkStaticDirty();
+}
+
+void RenderObject::UpdateAll(float stepSeconds)
+{
+	//Jobs only write their own chunk's spins and their own thread's list, the store is written once they are all done
+	static PerThread<RenderTransformWrites> writes;
+	EntityWorld::Instance()->ParallelForEachChunk<RenderSpin, RenderTransform>([stepSeconds](uint32_t count, const Entity*, RenderSpin* spins, RenderTransform* transforms)
+	{
+		RenderTransformWrites& local = writes.Local();
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			RenderSpin& spin = spins[i];
+			const float degrees = spin.mDegreesPerSecond * stepSeconds;
+			spin.mAngleX = fmod(spin.mAngleX + degrees, 360.0f);
+			spin.mAngleY = fmod(spin.mAngleY + degrees, 360.0f);
+			local.mTransforms.push_back(transforms[i].mTransform);
+			local.mRotations.push_back(Quaternion::FromAngleAxisFast(spin.mAngleX, up) * Quaternion::FromAngleAxisFast(spin.mAngleY, right));
+		}
+	});
+
+	TransformStore& store = *TransformStore::Instance();
+	for (uint32_t thread = 0; thread < writes.GetCount(); ++thread)
+	{
+		RenderTransformWrites& threadWrites = writes[thread];
+		store.SetLocalRotations(threadWrites.mTransforms.data(), threadWrites.mRotations.data(), static_cast<uint32_t>(threadWrites.mTransforms.size()));
+		threadWrites.mTransforms.clear();
+		threadWrites.mRotations.clear();
+	}
 }
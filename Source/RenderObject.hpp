@@ -1,35 +1,98 @@
 #pragma once
 #include "Quaternion.hpp"
+#include "Frustum.hpp"
+#include "TransformStore.hpp"
+#include "EntityWorld.hpp"
 
-class Matrix4;
+class AffineTransform;
 class Vector3;
 class Graphics;
 struct RenderVertex;
-class RenderObject
+
+//Everything only touched when uploading or recording draws. Stays on the heap because hal keeps pointers into it.
+//The game thread builds it with just the raw data, Graphics::CreateMesh has the render thread make the Vulkan side.
+struct RenderMesh
 {
-private:
-	Vector3 mPosition = Vector3(0.0f, 0.0f, 0.0f);
-	Vector3 mScale = Vector3(1.0f, 1.0f, 1.0f);
-	Quaternion mXRotation;
-	Quaternion mYRotation; //OOF
+	struct Resources
+	{
+		hal::Buffer mVertexBuffer;
+		hal::Buffer mIndexBuffer;
+		hal::DrawInfo mDrawInfo;
 
-	float currentAngleX = 45.0f;
-	float currentAngleY = 45.0f;
+		explicit Resources(RenderMesh& mesh);
+	};
 
 	std::vector<RenderVertex> mRawVertexBuffer;
 	std::vector<uint32_t> mRawIndexBuffer;
-	hal::Buffer mVertexBuffer;
-	hal::Buffer mIndexBuffer;
-	hal::DrawInfo mDrawInfo;
-	hal::DrawBuffer mDrawBuffer;// Man this really needs const correctness
+	std::unique_ptr<Resources> mResources; //Render thread only
+
+	RenderMesh(std::vector<RenderVertex> vertexBuffer, std::vector<uint32_t> indexBuffer);
+};
+
+//Components of a render object entity. The hot ones are a few bytes each so the update and cull passes stream through
+//packed arrays, the mesh is cold and sits in its own array the hot passes never read.
+struct RenderTransform
+{
+	TransformHandle mTransform;
+};
+
+struct RenderBounds
+{
+	BoundingSphere mLocalBounds;
+};
+
+struct RenderSpin
+{
+	float mAngleX = 45.0f;
+	float mAngleY = 45.0f;
+	float mDegreesPerSecond = 60.0f;
+};
+
+//Tags an object that never moves on its own. Static objects skip the per-frame cull and are drawn from a command buffer
+//Graphics records once, so they cost next to nothing per frame until one is added, moved or removed.
+struct RenderStatic
+{
+};
+
+//The mesh is handed back to Graphics::DestroyMesh rather than deleted, a frame the render thread hasn't drawn yet can
+//still point at it
+struct RenderMeshComponent
+{
+	RenderMesh* mMesh = nullptr;
+
+	RenderMeshComponent() = default;
+	RenderMeshComponent(RenderMeshComponent&& other) : mMesh(other.mMesh) { other.mMesh = nullptr; }
+	RenderMeshComponent& operator=(RenderMeshComponent&& other) { std::swap(mMesh, other.mMesh); return *this; }
+	~RenderMeshComponent();
+};
+
+//Rotations the parallel update worked out on one thread, handed to the TransformStore in one go once every thread is done
+struct RenderTransformWrites
+{
+	std::vector<TransformHandle> mTransforms;
+	std::vector<Quaternion> mRotations;
+};
+
+//Owns one entity in the EntityWorld and the TransformStore node it points at
+class RenderObject
+{
+private:
+	Entity mEntity;
 public:
 	RenderObject(std::vector<RenderVertex> vertexBuffer, std::vector<uint32_t> indexBuffer);
+	RenderObject(const RenderObject&) = delete;
+	RenderObject& operator=(const RenderObject&) = delete;
+	~RenderObject();
 
-	const hal::DrawInfo& GetDrawInfo() const { return mDrawInfo; }
-	hal::DrawBuffer* GetDrawBuffer() { return &mDrawBuffer; }
-	Matrix4 GetModelMatrix() const;
+	Entity GetEntity() const { return mEntity; }
+	TransformHandle GetTransform() const;
 
-	void SetPosition(Vector3 position) { mPosition = std::move(position); }
+	void SetPosition(const Vector3& position);
+	//Stops the spin and hands the object to Graphics' static draws. Only move it through SetPosition from then on.
+	void MakeStatic();
 
-	void Update();
+	//One simulation step of stepSeconds for every render object. Chunks are spread over the job threads and the new
+	//rotations are written to the TransformStore after they all finish, so call it before Graphics::Draw rebuilds the world
+	//matrices.
+	static void UpdateAll(float stepSeconds);
 };
\ No newline at end of file
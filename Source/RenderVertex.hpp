@@ -1,5 +1,6 @@
 #pragma once
 #include "Vector3.hpp"
+#include "Half.hpp"
 
 struct RenderVertex
 {
@@ -7,4 +8,30 @@ struct RenderVertex
 	Vector3 mColor;
 
 	RenderVertex(Vector3 position, Vector3 color) : mPosition(std::move(position)), mColor(std::move(color)) {}
-};
\ No newline at end of file
+};
+
+//16 byte twin of RenderVertex for meshes that fit in half precision. Bind both members as VK_FORMAT_R16G16B16A16_SFLOAT,
+//which every Vulkan device must support for vertex input, the shader still reads them as vec3 and ignores w.
+struct RenderVertexHalf
+{
+	Half4 mPosition;
+	Half4 mColor;
+
+	RenderVertexHalf() {}
+	explicit RenderVertexHalf(const RenderVertex& vertex) { Pack(&vertex, this, 1); }
+
+	static void Pack(const RenderVertex* in, RenderVertexHalf* out, size_t count)
+	{
+		for (size_t i = 0; i < count; ++i)
+		{
+			const float widened[8] =
+			{
+				in[i].mPosition.x, in[i].mPosition.y, in[i].mPosition.z, 1.0f,
+				in[i].mColor.x, in[i].mColor.y, in[i].mColor.z, 1.0f
+			};
+			Half::ToHalfBatch(widened, &out[i].mPosition.x, 8);
+		}
+	}
+};
+
+static_assert(sizeof(RenderVertexHalf) == 16, "RenderVertexHalf must stay tightly packed for the vertex buffer stride");
\ No newline at end of file
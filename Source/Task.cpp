@@ -0,0 +1,28 @@
+#include "precompiled.hpp"
+#include "Task.hpp"
+
+#include <fstream>
+
+Task<std::vector<char>> ReadFileAsync(std::string path)
+{
+	co_await ResumeOnJobs();
+
+	std::vector<char> bytes;
+	std::ifstream stream(path, std::ios::binary | std::ios::ate);
+	if (!stream.is_open())
+	{
+		co_return bytes;
+	}
+	const std::streamoff size = stream.tellg();
+	if (size > 0)
+	{
+		bytes.resize(static_cast<size_t>(size));
+		stream.seekg(0, std::ios::beg);
+		stream.read(bytes.data(), size);
+		if (!stream)
+		{
+			bytes.clear();
+		}
+	}
+	co_return bytes;
+}
\ No newline at end of file
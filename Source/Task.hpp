@@ -0,0 +1,207 @@
+#pragma once
+#include "JobSystem.hpp"
+
+#include <exception>
+#include <string>
+#include <utility>
+#include <vector>
+//VS2017 only has the coroutines TS, which needs /await and lives in std::experimental. Newer compilers have the real thing.
+#if defined(__cpp_impl_coroutine) || (defined(_MSVC_LANG) && _MSVC_LANG > 201703L)
+#include <coroutine>
+namespace coro = std;
+#else
+#include <experimental/coroutine>
+namespace coro = std::experimental;
+#endif
+
+template<typename T>
+class Task;
+
+namespace TaskDetail
+{
+	//The awaiter and the task finishing race to flip mStarted. Whoever gets there second knows both are done and resumes
+	//the awaiter, so a task that finishes straight away never resumes it from inside its own await_suspend.
+	struct PromiseBase
+	{
+		coro::coroutine_handle<> mContinuation;
+		std::atomic<bool> mStarted{ false };
+
+		struct FinalAwaiter
+		{
+			bool await_ready() noexcept { return false; }
+			template<typename Promise>
+			void await_suspend(coro::coroutine_handle<Promise> handle) noexcept
+			{
+				PromiseBase& promise = handle.promise();
+				if (promise.mStarted.exchange(true, std::memory_order_acq_rel))
+				{
+					promise.mContinuation.resume();
+				}
+			}
+			void await_resume() noexcept {}
+		};
+
+		coro::suspend_always initial_suspend() noexcept { return {}; }
+		FinalAwaiter final_suspend() noexcept { return {}; }
+		//Nothing here throws on purpose, treat it like any other crash
+		void unhandled_exception() { std::terminate(); }
+	};
+
+	template<typename T>
+	struct Promise : PromiseBase
+	{
+		T mValue;
+
+		Task<T> get_return_object();
+		template<typename U>
+		void return_value(U&& value) { mValue = std::forward<U>(value); }
+		T&& TakeResult() { return std::move(mValue); }
+	};
+
+	template<>
+	struct Promise<void> : PromiseBase
+	{
+		Task<void> get_return_object();
+		void return_void() {}
+		void TakeResult() {}
+	};
+
+	//Owns itself, starts straight away and frees its frame when it ends
+	struct Detached
+	{
+		struct promise_type
+		{
+			Detached get_return_object() { return {}; }
+			coro::suspend_never initial_suspend() noexcept { return {}; }
+			coro::suspend_never final_suspend() noexcept { return {}; }
+			void return_void() {}
+			void unhandled_exception() { std::terminate(); }
+		};
+	};
+}
+
+//A coroutine returning T. Nothing runs until it is co_awaited, and the awaiter carries on from wherever the task finished,
+//which after co_await ResumeOnJobs() or one of Graphics' awaitables is a different thread to the one it started on. Move
+//only, destroying an unfinished task that was never awaited is fine, destroying one that is running is not.
+template<typename T = void>
+class Task
+{
+public:
+	typedef TaskDetail::Promise<T> promise_type;
+
+	explicit Task(coro::coroutine_handle<promise_type> handle) : mHandle(handle) {}
+	Task(Task&& other) noexcept : mHandle(other.mHandle) { other.mHandle = nullptr; }
+	Task& operator=(Task&& other) noexcept
+	{
+		if (this != &other)
+		{
+			Destroy();
+			mHandle = other.mHandle;
+			other.mHandle = nullptr;
+		}
+		return *this;
+	}
+	Task(const Task&) = delete;
+	Task& operator=(const Task&) = delete;
+	~Task() { Destroy(); }
+
+	bool await_ready() const noexcept { return false; }
+	bool await_suspend(coro::coroutine_handle<> awaiter)
+	{
+		mHandle.promise().mContinuation = awaiter;
+		mHandle.resume();
+		//False when the task already finished, the awaiter then just carries on without suspending
+		return !mHandle.promise().mStarted.exchange(true, std::memory_order_acq_rel);
+	}
+	decltype(auto) await_resume() { return mHandle.promise().TakeResult(); }
+
+private:
+	coro::coroutine_handle<promise_type> mHandle;
+
+	void Destroy()
+	{
+		if (mHandle)
+		{
+			mHandle.destroy();
+			mHandle = nullptr;
+		}
+	}
+};
+
+template<typename T>
+Task<T> TaskDetail::Promise<T>::get_return_object()
+{
+	return Task<T>(coro::coroutine_handle<Promise<T>>::from_promise(*this));
+}
+
+inline Task<void> TaskDetail::Promise<void>::get_return_object()
+{
+	return Task<void>(coro::coroutine_handle<Promise<void>>::from_promise(*this));
+}
+
+//co_await ResumeOnJobs() carries on from a job thread. Works from any thread, including ones that aren't job threads.
+class ResumeOnJobs
+{
+private:
+	Job mJob;
+public:
+	bool await_ready() const noexcept { return false; }
+	void await_suspend(coro::coroutine_handle<> handle)
+	{
+		mJob.mFunction = [](void* data) { coro::coroutine_handle<>::from_address(data).resume(); };
+		mJob.mData = handle.address();
+		//The job may run and finish the coroutine, this included, before Schedule even returns
+		JobSystem::Instance()->Schedule(mJob);
+	}
+	void await_resume() noexcept {}
+};
+
+namespace TaskDetail
+{
+	template<typename T>
+	Detached RunDetached(Task<T> task, JobCounter* counter)
+	{
+		co_await task;
+		if (counter != nullptr)
+		{
+			JobSystem::Instance()->Release(*counter);
+		}
+	}
+}
+
+//Starts task on the calling thread and lets it run to the end on its own, counter is held until then if one is given. The
+//result is thrown away, so anything wanted out of it has to be stored by the task itself.
+template<typename T>
+void StartTask(Task<T> task, JobCounter* counter = nullptr)
+{
+	if (counter != nullptr)
+	{
+		JobSystem::Instance()->Hold(*counter);
+	}
+	TaskDetail::RunDetached(std::move(task), counter);
+}
+
+//Job threads only. Runs task and returns its result, running other jobs while it waits like JobSystem::Wait.
+template<typename T>
+T SyncWait(Task<T> task)
+{
+	struct Result
+	{
+		T mValue;
+	};
+	Result result;
+	JobCounter counter;
+	StartTask([](Task<T> inner, Result& out) -> Task<void> { out.mValue = co_await inner; }(std::move(task), result), &counter);
+	JobSystem::Instance()->Wait(counter);
+	return std::move(result.mValue);
+}
+
+inline void SyncWait(Task<void> task)
+{
+	JobCounter counter;
+	StartTask(std::move(task), &counter);
+	JobSystem::Instance()->Wait(counter);
+}
+
+//Reads a whole file on a job thread. Empty if it can't be opened.
+Task<std::vector<char>> ReadFileAsync(std::string path);
\ No newline at end of file
@@ -0,0 +1,156 @@
+#include "precompiled.hpp"
+#include "MathSIMD.hpp"
+#include "Vector3.hpp"
+#include "Matrix4.hpp"
+#include "RenderVertex.hpp"
+#include "TransformBatch.hpp"
+#include "JobSystem.hpp"
+
+#include <algorithm>
+
+namespace
+{
+	//w is 1 for points and 0 for directions, the translation column is skipped entirely for directions
+	template<bool IsPoint>
+	void TransformStream(const Matrix4& m, ConstVector3Stream in, Vector3Stream out, size_t count)
+	{
+		size_t i = 0;
+#if defined(MATH_SIMD_AVX2)
+		{
+			const __m256 m11 = _mm256_set1_ps(m.m11), m21 = _mm256_set1_ps(m.m21), m31 = _mm256_set1_ps(m.m31), m41 = _mm256_set1_ps(m.m41);
+			const __m256 m12 = _mm256_set1_ps(m.m12), m22 = _mm256_set1_ps(m.m22), m32 = _mm256_set1_ps(m.m32), m42 = _mm256_set1_ps(m.m42);
+			const __m256 m13 = _mm256_set1_ps(m.m13), m23 = _mm256_set1_ps(m.m23), m33 = _mm256_set1_ps(m.m33), m43 = _mm256_set1_ps(m.m43);
+			for (; i + 8 <= count; i += 8)
+			{
+				const __m256 x = _mm256_loadu_ps(in.x + i);
+				const __m256 y = _mm256_loadu_ps(in.y + i);
+				const __m256 z = _mm256_loadu_ps(in.z + i);
+				__m256 rx = _mm256_fmadd_ps(m31, z, _mm256_fmadd_ps(m21, y, _mm256_mul_ps(m11, x)));
+				__m256 ry = _mm256_fmadd_ps(m32, z, _mm256_fmadd_ps(m22, y, _mm256_mul_ps(m12, x)));
+				__m256 rz = _mm256_fmadd_ps(m33, z, _mm256_fmadd_ps(m23, y, _mm256_mul_ps(m13, x)));
+				if (IsPoint)
+				{
+					rx = _mm256_add_ps(rx, m41);
+					ry = _mm256_add_ps(ry, m42);
+					rz = _mm256_add_ps(rz, m43);
+				}
+				_mm256_storeu_ps(out.x + i, rx);
+				_mm256_storeu_ps(out.y + i, ry);
+				_mm256_storeu_ps(out.z + i, rz);
+			}
+		}
+#endif
+#if defined(MATH_SIMD_SSE2)
+		{
+			const __m128 m11 = _mm_set1_ps(m.m11), m21 = _mm_set1_ps(m.m21), m31 = _mm_set1_ps(m.m31), m41 = _mm_set1_ps(m.m41);
+			const __m128 m12 = _mm_set1_ps(m.m12), m22 = _mm_set1_ps(m.m22), m32 = _mm_set1_ps(m.m32), m42 = _mm_set1_ps(m.m42);
+			const __m128 m13 = _mm_set1_ps(m.m13), m23 = _mm_set1_ps(m.m23), m33 = _mm_set1_ps(m.m33), m43 = _mm_set1_ps(m.m43);
+			for (; i + 4 <= count; i += 4)
+			{
+				const __m128 x = _mm_loadu_ps(in.x + i);
+				const __m128 y = _mm_loadu_ps(in.y + i);
+				const __m128 z = _mm_loadu_ps(in.z + i);
+				__m128 rx = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m11, x), _mm_mul_ps(m21, y)), _mm_mul_ps(m31, z));
+				__m128 ry = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m12, x), _mm_mul_ps(m22, y)), _mm_mul_ps(m32, z));
+				__m128 rz = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m13, x), _mm_mul_ps(m23, y)), _mm_mul_ps(m33, z));
+				if (IsPoint)
+				{
+					rx = _mm_add_ps(rx, m41);
+					ry = _mm_add_ps(ry, m42);
+					rz = _mm_add_ps(rz, m43);
+				}
+				_mm_storeu_ps(out.x + i, rx);
+				_mm_storeu_ps(out.y + i, ry);
+				_mm_storeu_ps(out.z + i, rz);
+			}
+		}
+#endif
+		const float w = IsPoint ? 1.0f : 0.0f;
+		for (; i < count; ++i)
+		{
+			const float x = in.x[i];
+			const float y = in.y[i];
+			const float z = in.z[i];
+			out.x[i] = m.m11 * x + m.m21 * y + m.m31 * z + m.m41 * w;
+			out.y[i] = m.m12 * x + m.m22 * y + m.m32 * z + m.m42 * w;
+			out.z[i] = m.m13 * x + m.m23 * y + m.m33 * z + m.m43 * w;
+		}
+	}
+
+	template<bool IsPoint>
+	void TransformStreamParallel(const Matrix4& m, ConstVector3Stream in, Vector3Stream out, size_t count)
+	{
+		if (count < TransformBatch::ParallelThreshold)
+		{
+			TransformStream<IsPoint>(m, in, out, count);
+			return;
+		}
+
+		//A few pieces per thread so stealing can even out the load, kept a multiple of 8 so only the last piece runs the
+		//scalar tail
+		assert(count <= 0xffffffffu);
+		JobSystem& jobs = *JobSystem::Instance();
+		const size_t pieceCount = static_cast<size_t>(jobs.GetThreadCount()) * 4;
+		const uint32_t grainSize = static_cast<uint32_t>((((count + pieceCount - 1) / pieceCount) + 7) & ~static_cast<size_t>(7));
+		jobs.ParallelFor(0, static_cast<uint32_t>(count), grainSize, [&](uint32_t begin, uint32_t end)
+		{
+			const ConstVector3Stream pieceIn(in.x + begin, in.y + begin, in.z + begin);
+			const Vector3Stream pieceOut = { out.x + begin, out.y + begin, out.z + begin };
+			TransformStream<IsPoint>(m, pieceIn, pieceOut, end - begin);
+		});
+	}
+}
+
+void TransformBatch::TransformPoints(const Matrix4& matrix, ConstVector3Stream in, Vector3Stream out, size_t count)
+{
+	TransformStream<true>(matrix, in, out, count);
+}
+
+void TransformBatch::TransformDirections(const Matrix4& matrix, ConstVector3Stream in, Vector3Stream out, size_t count)
+{
+	TransformStream<false>(matrix, in, out, count);
+}
+
+void TransformBatch::TransformPoints(const Matrix4& matrix, const RenderVertex* in, RenderVertex* out, size_t count)
+{
+#if defined(MATH_SIMD_SSE2)
+	//Interleaved data, so work a vertex at a time as a sum of the matrix columns
+	const __m128 c0 = _mm_load_ps(matrix.matrix[0]);
+	const __m128 c1 = _mm_load_ps(matrix.matrix[1]);
+	const __m128 c2 = _mm_load_ps(matrix.matrix[2]);
+	const __m128 c3 = _mm_load_ps(matrix.matrix[3]);
+	for (size_t i = 0; i < count; ++i)
+	{
+		const Vector3& position = in[i].mPosition;
+		const __m128 result = _mm_add_ps(
+			_mm_add_ps(_mm_mul_ps(c0, _mm_set1_ps(position.x)), _mm_mul_ps(c1, _mm_set1_ps(position.y))),
+			_mm_add_ps(_mm_mul_ps(c2, _mm_set1_ps(position.z)), c3));
+
+		//Only write three lanes, the fourth would land on mColor
+		float* target = out[i].mPosition.vector;
+		_mm_storel_pi(reinterpret_cast<__m64*>(target), result);
+		_mm_store_ss(target + 2, _mm_movehl_ps(result, result));
+	}
+#else
+	for (size_t i = 0; i < count; ++i)
+	{
+		const Vector3 position = in[i].mPosition;
+		out[i].mPosition = Vector3
+		(
+			matrix.m11 * position.x + matrix.m21 * position.y + matrix.m31 * position.z + matrix.m41,
+			matrix.m12 * position.x + matrix.m22 * position.y + matrix.m32 * position.z + matrix.m42,
+			matrix.m13 * position.x + matrix.m23 * position.y + matrix.m33 * position.z + matrix.m43
+		);
+	}
+#endif
+}
+
+void TransformBatch::TransformPointsParallel(const Matrix4& matrix, ConstVector3Stream in, Vector3Stream out, size_t count)
+{
+	TransformStreamParallel<true>(matrix, in, out, count);
+}
+
+void TransformBatch::TransformDirectionsParallel(const Matrix4& matrix, ConstVector3Stream in, Vector3Stream out, size_t count)
+{
+	TransformStreamParallel<false>(matrix, in, out, count);
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+class Matrix4;
+struct RenderVertex;
+
+//Structure of arrays view over count positions or directions, x, y and z live in separate float streams
+struct Vector3Stream
+{
+	float* x;
+	float* y;
+	float* z;
+};
+
+struct ConstVector3Stream
+{
+	const float* x;
+	const float* y;
+	const float* z;
+
+	ConstVector3Stream(const float* inX, const float* inY, const float* inZ) : x(inX), y(inY), z(inZ) {}
+	ConstVector3Stream(const Vector3Stream& stream) : x(stream.x), y(stream.y), z(stream.z) {}
+};
+
+//Transforms many points at once. Unlike Matrix4::operator*(Vector3) these follow the shader convention, matrix * column vector.
+//Points get w = 1, directions get w = 0. Input and output streams may be the same memory.
+class TransformBatch
+{
+public:
+	static constexpr size_t ParallelThreshold = 32768; //Below this waking the workers costs more than it saves
+
+	static void TransformPoints(const Matrix4& matrix, ConstVector3Stream in, Vector3Stream out, size_t count);
+	static void TransformDirections(const Matrix4& matrix, ConstVector3Stream in, Vector3Stream out, size_t count);
+
+	//Only touches mPosition, colours are left alone
+	static void TransformPoints(const Matrix4& matrix, const RenderVertex* in, RenderVertex* out, size_t count);
+
+	//Splits the streams over the JobSystem with ParallelFor, the calling thread works on them too
+	static void TransformPointsParallel(const Matrix4& matrix, ConstVector3Stream in, Vector3Stream out, size_t count);
+	static void TransformDirectionsParallel(const Matrix4& matrix, ConstVector3Stream in, Vector3Stream out, size_t count);
+};
\ No newline at end of file
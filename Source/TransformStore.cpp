@@ -0,0 +1,297 @@
+#include "precompiled.hpp"
+#include "Vector3.hpp"
+#include "Quaternion.hpp"
+#include "AffineTransform.hpp"
+#include "TransformStore.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+transform_store_ptr TransformStore::s_Instance = nullptr;
+
+namespace
+{
+	constexpr uint32_t cNone = TransformHandle::InvalidIndex;
+
+	template<typename T>
+	void Gather(std::vector<T>& values, const std::vector<uint32_t>& order)
+	{
+		std::vector<T> gathered;
+		gathered.reserve(order.size());
+		for (uint32_t index : order)
+		{
+			gathered.push_back(values[index]);
+		}
+		values.swap(gathered);
+	}
+}
+
+void TransformStore::CreateInstance()
+{
+	if (s_Instance == nullptr)
+	{
+		s_Instance = static_cast<transform_store_ptr>(new TransformStore());
+	}
+}
+
+const transform_store_ptr & TransformStore::Instance()
+{
+	assert(s_Instance != nullptr);
+	return s_Instance;
+}
+
+void TransformStore::DestroyInstance()
+{
+	s_Instance.reset();
+}
+
+uint32_t TransformStore::Dense(TransformHandle handle) const
+{
+	assert(IsAlive(handle));
+	return mSlotToDense[handle.mSlot];
+}
+
+bool TransformStore::IsAlive(TransformHandle handle) const
+{
+	return handle.mSlot < mSlotToDense.size() && mSlotGenerations[handle.mSlot] == handle.mGeneration && mSlotToDense[handle.mSlot] != cNone;
+}
+
+void TransformStore::MarkDirty(uint32_t dense)
+{
+	mDirty[dense] = 1;
+	mFirstDirty = (std::min)(mFirstDirty, dense);
+}
+
+TransformHandle TransformStore::Create(TransformHandle parent)
+{
+	const uint32_t dense = static_cast<uint32_t>(mParents.size());
+	TransformHandle handle;
+	if (!mFreeSlots.empty())
+	{
+		handle.mSlot = mFreeSlots.back();
+		mFreeSlots.pop_back();
+	}
+	else
+	{
+		handle.mSlot = static_cast<uint32_t>(mSlotToDense.size());
+		mSlotToDense.push_back(cNone);
+		mSlotGenerations.push_back(0);
+	}
+	handle.mGeneration = mSlotGenerations[handle.mSlot];
+
+	//Appending keeps the order valid since the parent is already somewhere before the end
+	mLocalPositions.push_back(Vector3(0.0f, 0.0f, 0.0f));
+	mLocalRotations.push_back(Quaternion::Identity());
+	mLocalScales.push_back(Vector3(1.0f, 1.0f, 1.0f));
+	mParents.push_back(parent.IsValid() ? Dense(parent) : cNone);
+	mDirty.push_back(0);
+	mWorldMatrices.push_back(AffineTransform());
+	mWorldVersions.push_back(0);
+	mPreviousWorldMatrices.push_back(AffineTransform());
+	mHasPrevious.push_back(0);
+	mDenseToSlot.push_back(handle.mSlot);
+	mSlotToDense[handle.mSlot] = dense;
+	MarkDirty(dense);
+	return handle;
+}
+
+void TransformStore::Destroy(TransformHandle handle)
+{
+	const uint32_t root = Dense(handle);
+	const uint32_t count = static_cast<uint32_t>(mParents.size());
+
+	//Descendants always come after their parent so one forward pass finds the whole subtree
+	std::vector<uint8_t> removed(count, 0);
+	removed[root] = 1;
+	std::vector<uint32_t> survivors;
+	survivors.reserve(count);
+	for (uint32_t i = 0; i < root; ++i)
+	{
+		survivors.push_back(i);
+	}
+	for (uint32_t i = root; i < count; ++i)
+	{
+		if (i != root && (mParents[i] == cNone || !removed[mParents[i]]))
+		{
+			survivors.push_back(i);
+			continue;
+		}
+		removed[i] = 1;
+		const uint32_t slot = mDenseToSlot[i];
+		mSlotToDense[slot] = cNone;
+		++mSlotGenerations[slot];
+		mFreeSlots.push_back(slot);
+	}
+	Reorder(survivors);
+}
+
+void TransformStore::SetParent(TransformHandle handle, TransformHandle parent)
+{
+	const uint32_t child = Dense(handle);
+	const uint32_t parentDense = parent.IsValid() ? Dense(parent) : cNone;
+	for (uint32_t ancestor = parentDense; ancestor != cNone; ancestor = mParents[ancestor])
+	{
+		assert(ancestor != child);
+	}
+
+	mParents[child] = parentDense;
+	MarkDirty(child);
+	if (parentDense == cNone || parentDense < child)
+	{
+		return;
+	}
+
+	//The new parent comes after the child. Sorting by depth puts every parent back in front of its children.
+	const uint32_t count = static_cast<uint32_t>(mParents.size());
+	std::vector<uint32_t> depths(count, cNone);
+	std::vector<uint32_t> path;
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		uint32_t node = i;
+		while (depths[node] == cNone && mParents[node] != cNone && depths[mParents[node]] == cNone)
+		{
+			path.push_back(node);
+			node = mParents[node];
+		}
+		if (depths[node] == cNone)
+		{
+			depths[node] = mParents[node] == cNone ? 0 : depths[mParents[node]] + 1;
+		}
+		while (!path.empty())
+		{
+			depths[path.back()] = depths[mParents[path.back()]] + 1;
+			path.pop_back();
+		}
+	}
+
+	std::vector<uint32_t> order(count);
+	std::iota(order.begin(), order.end(), 0u);
+	std::stable_sort(order.begin(), order.end(), [&depths](uint32_t a, uint32_t b) { return depths[a] < depths[b]; });
+	Reorder(order);
+}
+
+void TransformStore::Reorder(const std::vector<uint32_t>& newOrder)
+{
+	std::vector<uint32_t> oldToNew(mParents.size(), cNone);
+	for (uint32_t i = 0; i < newOrder.size(); ++i)
+	{
+		oldToNew[newOrder[i]] = i;
+	}
+
+	Gather(mLocalPositions, newOrder);
+	Gather(mLocalRotations, newOrder);
+	Gather(mLocalScales, newOrder);
+	Gather(mParents, newOrder);
+	Gather(mDirty, newOrder);
+	Gather(mWorldMatrices, newOrder);
+	Gather(mWorldVersions, newOrder);
+	Gather(mPreviousWorldMatrices, newOrder);
+	Gather(mHasPrevious, newOrder);
+	Gather(mDenseToSlot, newOrder);
+
+	mFirstDirty = static_cast<uint32_t>(mParents.size());
+	for (uint32_t i = 0; i < mParents.size(); ++i)
+	{
+		if (mParents[i] != cNone)
+		{
+			mParents[i] = oldToNew[mParents[i]];
+			assert(mParents[i] < i);
+		}
+		mSlotToDense[mDenseToSlot[i]] = i;
+		if (mDirty[i])
+		{
+			mFirstDirty = (std::min)(mFirstDirty, i);
+		}
+	}
+}
+
+void TransformStore::SetLocalPosition(TransformHandle handle, const Vector3& position)
+{
+	const uint32_t dense = Dense(handle);
+	mLocalPositions[dense] = position;
+	MarkDirty(dense);
+}
+
+void TransformStore::SetLocalRotation(TransformHandle handle, const Quaternion& rotation)
+{
+	const uint32_t dense = Dense(handle);
+	mLocalRotations[dense] = rotation;
+	MarkDirty(dense);
+}
+
+void TransformStore::SetLocalScale(TransformHandle handle, const Vector3& scale)
+{
+	const uint32_t dense = Dense(handle);
+	mLocalScales[dense] = scale;
+	MarkDirty(dense);
+}
+
+void TransformStore::SetLocalTRS(TransformHandle handle, const Vector3& position, const Quaternion& rotation, const Vector3& scale)
+{
+	const uint32_t dense = Dense(handle);
+	mLocalPositions[dense] = position;
+	mLocalRotations[dense] = rotation;
+	mLocalScales[dense] = scale;
+	MarkDirty(dense);
+}
+
+void TransformStore::SetLocalRotations(const TransformHandle* handles, const Quaternion* rotations, uint32_t count)
+{
+	uint32_t firstDirty = mFirstDirty;
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		const uint32_t dense = Dense(handles[i]);
+		mLocalRotations[dense] = rotations[i];
+		mDirty[dense] = 1;
+		firstDirty = (std::min)(firstDirty, dense);
+	}
+	mFirstDirty = firstDirty;
+}
+
+void TransformStore::UpdateWorldMatrices()
+{
+	const uint32_t count = static_cast<uint32_t>(mParents.size());
+	if (mFirstDirty >= count)
+	{
+		return;
+	}
+
+	//Parents are always earlier in the arrays, so by the time we reach a node its parent's flag and matrix are final
+	++mUpdateVersion;
+	for (uint32_t i = mFirstDirty; i < count; ++i)
+	{
+		const uint32_t parent = mParents[i];
+		if (parent != cNone && mDirty[parent])
+		{
+			mDirty[i] = 1;
+		}
+		if (!mDirty[i])
+		{
+			continue;
+		}
+
+		const AffineTransform local = AffineTransform::FromTRS(mLocalPositions[i], mLocalRotations[i], mLocalScales[i]);
+		mWorldMatrices[i] = parent != cNone ? mWorldMatrices[parent] * local : local;
+		mWorldVersions[i] = mUpdateVersion;
+	}
+
+	std::fill(mDirty.begin() + mFirstDirty, mDirty.end(), static_cast<uint8_t>(0));
+	mFirstDirty = count;
+}
+
+void TransformStore::BeginSimulationStep()
+{
+	UpdateWorldMatrices();
+	mPreviousWorldMatrices = mWorldMatrices;
+	std::fill(mHasPrevious.begin(), mHasPrevious.end(), static_cast<uint8_t>(1));
+}
+
+AffineTransform TransformStore::GetInterpolatedWorldMatrix(TransformHandle handle, float alpha) const
+{
+	const uint32_t dense = Dense(handle);
+	if (!mHasPrevious[dense])
+	{
+		return mWorldMatrices[dense];
+	}
+	return AffineTransform::Lerp(mPreviousWorldMatrices[dense], mWorldMatrices[dense], alpha);
+}
\ No newline at end of file
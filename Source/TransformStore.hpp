@@ -0,0 +1,87 @@
+#pragma once
+#include "Vector3.hpp"
+#include "Quaternion.hpp"
+#include "AffineTransform.hpp"
+
+//Stays valid however the store reorders its arrays. A destroyed node's handle is caught by the generation check.
+struct TransformHandle
+{
+	static constexpr uint32_t InvalidIndex = 0xffffffffu;
+	uint32_t mSlot = InvalidIndex;
+	uint32_t mGeneration = 0;
+
+	bool IsValid() const { return mSlot != InvalidIndex; }
+};
+
+class TransformStore;
+typedef std::unique_ptr<TransformStore> transform_store_ptr;
+//Local position, rotation and scale for every node, one array per component, sorted so a parent always comes before its
+//children. UpdateWorldMatrices walks the arrays once from the first dirty node and only rebuilds dirty nodes and their
+//descendants, so a frame where nothing moved costs nothing.
+class TransformStore
+{
+private:
+	static transform_store_ptr s_Instance;
+
+	//Dense, indexed by position in the sorted order
+	std::vector<Vector3> mLocalPositions;
+	std::vector<Quaternion> mLocalRotations;
+	std::vector<Vector3> mLocalScales;
+	std::vector<uint32_t> mParents;
+	std::vector<uint8_t> mDirty;
+	std::vector<AffineTransform> mWorldMatrices;
+	std::vector<uint32_t> mWorldVersions;
+	//World matrices as they were when the last simulation step began, and whether the node existed then
+	std::vector<AffineTransform> mPreviousWorldMatrices;
+	std::vector<uint8_t> mHasPrevious;
+	std::vector<uint32_t> mDenseToSlot;
+
+	//Sparse, indexed by handle slot
+	std::vector<uint32_t> mSlotToDense;
+	std::vector<uint32_t> mSlotGenerations;
+	std::vector<uint32_t> mFreeSlots;
+
+	uint32_t mFirstDirty = 0;
+	uint32_t mUpdateVersion = 0;
+
+	TransformStore() {}
+	uint32_t Dense(TransformHandle handle) const;
+	void MarkDirty(uint32_t dense);
+	//Moves every node to newOrder[i] == old dense index, keeping parents and handles pointing at the right places
+	void Reorder(const std::vector<uint32_t>& newOrder);
+public:
+	static void CreateInstance();
+	static const transform_store_ptr& Instance();
+	static void DestroyInstance();
+
+	//New nodes start at the identity. The parent has to exist already, pass an invalid handle for a root.
+	TransformHandle Create(TransformHandle parent = TransformHandle());
+	//Destroys the node and everything below it
+	void Destroy(TransformHandle handle);
+	//Re-sorts the arrays if the parent currently sits after the child, asserts on cycles
+	void SetParent(TransformHandle handle, TransformHandle parent);
+	bool IsAlive(TransformHandle handle) const;
+
+	void SetLocalPosition(TransformHandle handle, const Vector3& position);
+	void SetLocalRotation(TransformHandle handle, const Quaternion& rotation);
+	void SetLocalScale(TransformHandle handle, const Vector3& scale);
+	void SetLocalTRS(TransformHandle handle, const Vector3& position, const Quaternion& rotation, const Vector3& scale);
+	//Same as calling SetLocalRotation count times, for applying the writes a parallel update gathered up
+	void SetLocalRotations(const TransformHandle* handles, const Quaternion* rotations, uint32_t count);
+
+	const Vector3& GetLocalPosition(TransformHandle handle) const { return mLocalPositions[Dense(handle)]; }
+	const Quaternion& GetLocalRotation(TransformHandle handle) const { return mLocalRotations[Dense(handle)]; }
+	const Vector3& GetLocalScale(TransformHandle handle) const { return mLocalScales[Dense(handle)]; }
+	//As of the last UpdateWorldMatrices
+	const AffineTransform& GetWorldMatrix(TransformHandle handle) const { return mWorldMatrices[Dense(handle)]; }
+	//Changes every time the node's world matrix is rebuilt, lets caches built from it tell when they are stale
+	uint32_t GetWorldVersion(TransformHandle handle) const { return mWorldVersions[Dense(handle)]; }
+	size_t GetCount() const { return mParents.size(); }
+
+	void UpdateWorldMatrices();
+	//Call before every fixed simulation step. Brings the world matrices up to date and keeps them as where the step started.
+	void BeginSimulationStep();
+	//Between where the last simulation step started, at 0, and the last UpdateWorldMatrices, at 1. Nodes created since
+	//the step began have nothing to come from and just give their world matrix.
+	AffineTransform GetInterpolatedWorldMatrix(TransformHandle handle, float alpha) const;
+};
\ No newline at end of file
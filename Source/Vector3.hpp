@@ -1,4 +1,5 @@
 #pragma once
+#include "ConstexprMath.hpp"
 
 class Vector4;
 class Vector3
@@ -14,19 +15,31 @@ public:
 		};
 		float vector[3];
 	};
-	Vector3() : x(0.0f), y(0.0f), z(0.0f) {}
-	Vector3(float inX, float inY, float inZ);
+	constexpr Vector3() : x(0.0f), y(0.0f), z(0.0f) {}
+	constexpr Vector3(float inX, float inY, float inZ) : x(inX), y(inY), z(inZ) {}
 	Vector3(const Vector4& inVec);
 
 	float& operator[](uint32_t i);
-	Vector3 operator*(const float b) const;
-	Vector3 operator+(const Vector3& b) const;
-	Vector3 operator-(const Vector3& b) const;
+	constexpr Vector3 operator*(const float b) const { return Vector3(x * b, y * b, z * b); }
+	constexpr Vector3 operator+(const Vector3& b) const { return Vector3(x + b.x, y + b.y, z + b.z); }
+	constexpr Vector3 operator-(const Vector3& b) const { return Vector3(x - b.x, y - b.y, z - b.z); }
+	constexpr Vector3 operator-() const { return Vector3(-x, -y, -z); }
 	void operator=(const Vector4& b);
 
 	float Magnitude() const;
-	Vector3 Cross(const Vector3& b) const;
-	float Dot(const Vector3& b) const;
+	constexpr float MagnitudeSquared() const { return (x * x) + (y * y) + (z * z); }
+	constexpr Vector3 Cross(const Vector3& b) const
+	{
+		return Vector3
+		(
+			(y * b.z) - (z * b.y),
+			(z * b.x) - (x * b.z),
+			(x * b.y) - (y * b.x)
+		);
+	}
+	constexpr float Dot(const Vector3& b) const { return (x * b.x) + (y * b.y) + (z * b.z); }
 	const Vector3 GetNormal();
 	const Vector3 GetNormal() const;
+	//Same as GetNormal but usable in constant expressions, slower at runtime
+	constexpr Vector3 ConstexprNormal() const { return *this * (1.0f / ConstexprMath::Sqrt(MagnitudeSquared())); }
 };
\ No newline at end of file
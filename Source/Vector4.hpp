@@ -1,7 +1,7 @@
 #pragma once
+#include "Vector3.hpp"
 
-class Vector3;
-class Vector4 //OOF
+class alignas(16) Vector4 //OOF
 {
 public:
 	union
@@ -16,7 +16,7 @@ public:
 		float vector[4];
 	};
 	Vector4() {}
-	Vector4(float inX, float inY, float inZ, float inW);
-	Vector4(const Vector3& vec, float inW);
+	constexpr Vector4(float inX, float inY, float inZ, float inW) : x(inX), y(inY), z(inZ), w(inW) {}
+	constexpr Vector4(const Vector3& vec, float inW) : x(vec.x), y(vec.y), z(vec.z), w(inW) {}
 	float& operator[](uint32_t i);
 };
\ No newline at end of file
@@ -1,5 +1,18 @@
 #pragma once
 
+#ifdef _WIN32
 #include <Windows.h>
 #include <includes.hpp>
-#include <halcyonic_render.hpp>
\ No newline at end of file
+#include <halcyonic_render.hpp>
+#else
+//Headless builds such as Benchmark/ only compile the math sources, so just the std headers they lean on
+#include <cmath>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <vector>
+#include <string>
+#include <functional>
+#endif
\ No newline at end of file
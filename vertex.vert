@@ -8,11 +8,14 @@ layout (location = 1) in vec3 inColor;
 
 layout (location = 0) out vec3 outColor;
 
-layout (binding = 0) uniform Block 
+layout (binding = 0) uniform ObjectBlock //Bound at a dynamic offset per draw, one block per object
 {
-	mat4 modelMatrix;
-	mat4 viewMatrix;
-    mat4 projectionMatrix;
+	layout (row_major) mat4x3 modelMatrix; //AffineTransform, three rows of four
+};
+
+layout (binding = 1) uniform FrameBlock
+{
+	mat4 viewProjectionMatrix; //Premultiplied on the CPU once per frame
 };
 
 out gl_PerVertex 
@@ -23,5 +26,6 @@ out gl_PerVertex
 void main() 
 {
 	outColor = inColor;
-	gl_Position = projectionMatrix * viewMatrix * modelMatrix * vec4(inPosition.x, inPosition.y, inPosition.z, 1.0);
+	vec3 worldPosition = modelMatrix * vec4(inPosition, 1.0);
+	gl_Position = viewProjectionMatrix * vec4(worldPosition, 1.0);
 }
\ No newline at end of file